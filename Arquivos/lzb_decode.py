@@ -0,0 +1,90 @@
+import binascii
+import struct
+import sys
+from multiprocessing import Pool
+
+# Descomprime o arquivo de blocos (dados.lzb) gravado pelo datalogger com
+# LOG_COMPRESS=1 e gera o CSV equivalente. Cada bloco tem cabeçalho próprio
+# (ver lib/lzblock.h), então os blocos são decodificados em paralelo.
+
+HEADER = struct.Struct('<4sHHHBB')
+MAGIC = b'LZB1'
+FLAG_RAW = 0x01
+
+
+def lz4_bloco(payload, raw_len):
+    out = bytearray()
+    i = 0
+    n = len(payload)
+    while i < n:
+        token = payload[i]
+        i += 1
+
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = payload[i]
+                i += 1
+                lit += b
+                if b != 255:
+                    break
+        out += payload[i:i + lit]
+        i += lit
+        if i >= n:
+            break
+
+        offset = payload[i] | (payload[i + 1] << 8)
+        i += 2
+        mlen = token & 0x0F
+        if mlen == 15:
+            while True:
+                b = payload[i]
+                i += 1
+                mlen += b
+                if b != 255:
+                    break
+        mlen += 4
+
+        inicio = len(out) - offset
+        for k in range(mlen):
+            out.append(out[inicio + k])
+
+    if len(out) != raw_len:
+        raise ValueError('tamanho descomprimido inválido')
+    return bytes(out)
+
+
+def decodificar(bloco):
+    indice, raw_len, crc, flags, payload = bloco
+    raw = payload if flags & FLAG_RAW else lz4_bloco(payload, raw_len)
+    if binascii.crc_hqx(raw, 0) != crc:
+        raise ValueError(f'CRC inválido no bloco {indice}')
+    return raw
+
+
+def ler_blocos(caminho):
+    with open(caminho, 'rb') as f:
+        dados = f.read()
+    pos = 0
+    indice = 0
+    while pos + HEADER.size <= len(dados):
+        magic, raw_len, payload_len, crc, flags, _ = HEADER.unpack_from(dados, pos)
+        if magic != MAGIC:
+            raise ValueError(f'magic inválido na posição {pos}')
+        pos += HEADER.size
+        yield (indice, raw_len, crc, flags, dados[pos:pos + payload_len])
+        pos += payload_len
+        indice += 1
+
+
+if __name__ == '__main__':
+    entrada = sys.argv[1] if len(sys.argv) > 1 else 'Arquivos/dados.lzb'
+    saida = sys.argv[2] if len(sys.argv) > 2 else 'Arquivos/dados.csv'
+
+    with Pool() as pool:
+        partes = pool.map(decodificar, ler_blocos(entrada))
+
+    with open(saida, 'wb') as f:
+        for parte in partes:
+            f.write(parte)
+    print(f'{len(partes)} blocos decodificados em {saida}')
@@ -6,28 +6,34 @@ nome_arquivo = 'Arquivos/dados.csv'
 # Lê o CSV com separador por ponto e vírgula
 df = pd.read_csv(nome_arquivo, encoding='utf-8-sig', sep=';')
 
+# Uma linha por sensor em cada amostra; arquivos antigos não têm a coluna
+if 'sensor' not in df.columns:
+    df['sensor'] = 0
+sensores = sorted(df['sensor'].unique())
+
+
+def plotar(eixos, unidade, titulo):
+    plt.figure(figsize=(10, 6))
+    for sensor in sensores:
+        dados = df[df['sensor'] == sensor]
+        for eixo in eixos:
+            rotulo = eixo if len(sensores) == 1 else f'{eixo} (sensor {sensor})'
+            plt.plot(dados['numero_amostra'], dados[eixo], label=rotulo)
+    plt.xlabel('Número da Amostra')
+    plt.ylabel(unidade)
+    plt.title(titulo)
+    plt.legend()
+    plt.grid(True)
+    plt.tight_layout()
+    plt.show()
+
+
 # Gráfico de Aceleração
-plt.figure(figsize=(10, 6))
-plt.plot(df['numero_amostra'], df['accel_x'], label='accel_x')
-plt.plot(df['numero_amostra'], df['accel_y'], label='accel_y')
-plt.plot(df['numero_amostra'], df['accel_z'], label='accel_z')
-plt.xlabel('Número da Amostra')
-plt.ylabel('Aceleração (g)')
-plt.title('Dados de Aceleração')
-plt.legend()
-plt.grid(True)
-plt.tight_layout()
-plt.show()
+plotar(['accel_x', 'accel_y', 'accel_z'], 'Aceleração (g)', 'Dados de Aceleração')
 
 # Gráfico de Giroscópio
-plt.figure(figsize=(10, 6))
-plt.plot(df['numero_amostra'], df['giro_x'], label='giro_x')
-plt.plot(df['numero_amostra'], df['giro_y'], label='giro_y')
-plt.plot(df['numero_amostra'], df['giro_z'], label='giro_z')
-plt.xlabel('Número da Amostra')
-plt.ylabel('Velocidade Angular (°/s)')
-plt.title('Dados do Giroscópio')
-plt.legend()
-plt.grid(True)
-plt.tight_layout()
-plt.show()
+plotar(['giro_x', 'giro_y', 'giro_z'], 'Velocidade Angular (°/s)', 'Dados do Giroscópio')
+
+# Gráfico de Orientação (só com orientacao = 1 no config.ini)
+if 'roll' in df.columns:
+    plotar(['roll', 'pitch', 'yaw'], 'Ângulo (°)', 'Orientação')
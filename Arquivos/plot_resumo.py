@@ -0,0 +1,34 @@
+import sys
+
+import pandas as pd
+import matplotlib.pyplot as plt
+
+# Pré-visualiza o resumo decimado (resumo.csv, com resumo_hz no config.ini):
+# a média filtrada de cada eixo, com a faixa entre o mínimo e o máximo de
+# cada período. Para capturas longas, sem ler o dados.csv inteiro.
+nome_arquivo = sys.argv[1] if len(sys.argv) > 1 else 'Arquivos/resumo.csv'
+
+df = pd.read_csv(nome_arquivo, encoding='utf-8-sig', sep=';')
+sensores = sorted(df['sensor'].unique())
+
+
+def plotar(eixos, unidade, titulo):
+    fig, graficos = plt.subplots(len(eixos), 1, figsize=(10, 8), sharex=True)
+    for grafico, eixo in zip(graficos, eixos):
+        for sensor in sensores:
+            dados = df[df['sensor'] == sensor]
+            rotulo = 'média' if len(sensores) == 1 else f'média (sensor {sensor})'
+            linha, = grafico.plot(dados['numero_amostra'], dados[f'{eixo}_media'], label=rotulo)
+            grafico.fill_between(dados['numero_amostra'], dados[f'{eixo}_min'], dados[f'{eixo}_max'],
+                                 color=linha.get_color(), alpha=0.25)
+        grafico.set_ylabel(f'{eixo} ({unidade})')
+        grafico.grid(True)
+    graficos[0].set_title(titulo)
+    graficos[0].legend()
+    graficos[-1].set_xlabel('Número da Amostra')
+    plt.tight_layout()
+    plt.show()
+
+
+plotar(['accel_x', 'accel_y', 'accel_z'], 'g', 'Resumo da Aceleração (média, mínimo e máximo)')
+plotar(['giro_x', 'giro_y', 'giro_z'], '°/s', 'Resumo do Giroscópio (média, mínimo e máximo)')
@@ -0,0 +1,90 @@
+import json
+import re
+import struct
+import sys
+
+# Converte o trace do datalogger (firmware compilado com TRACE=1) para o
+# formato JSON de trace do Chrome, aberto em chrome://tracing ou
+# ui.perfetto.dev. A entrada pode ser o trace.bin gravado pelo comando
+# "trace sd" ou o log do terminal serial com as linhas "[TRACE] <hex>" do
+# comando "trace". Cada núcleo vira uma linha do tempo; os pares início/fim
+# viram intervalos e os eventos instantâneos, marcas.
+
+REGISTRO = struct.Struct('<IBBH')  # ver trace_registro_t em lib/trace.h
+MAGIC = b'TRC1'
+
+NOMES = ['leitura', 'fila', 'bloco', 'gravacao', 'sync', 'sd_bloco', 'spi_dma', 'sd_ocupado']
+FASE_FIM = 0x80
+FASE_INSTANTE = 0x40
+
+
+def ler_registros(caminho):
+    with open(caminho, 'rb') as f:
+        dados = f.read()
+    if dados.startswith(MAGIC):
+        corpo = dados[len(MAGIC):]
+        corpo = corpo[:len(corpo) - len(corpo) % REGISTRO.size]
+        return [REGISTRO.unpack_from(corpo, i) for i in range(0, len(corpo), REGISTRO.size)]
+
+    registros = []
+    for linha in dados.decode('utf-8', 'replace').splitlines():
+        m = re.search(r'\[TRACE\] ([0-9a-f]{16})$', linha.strip())
+        if m:
+            registros.append(REGISTRO.unpack(bytes.fromhex(m.group(1))))
+    return registros
+
+
+def converter(registros):
+    # O tempo é de 32 bits em µs: desfaz as voltas do contador (~71 min) por núcleo
+    eventos = []
+    ultimo = {}
+    base = {}
+    for t, evento, nucleo, arg in registros:
+        if nucleo in ultimo and t < ultimo[nucleo]:
+            base[nucleo] = base.get(nucleo, 0) + (1 << 32)
+        ultimo[nucleo] = t
+        eventos.append((t + base.get(nucleo, 0), evento, nucleo, arg))
+    eventos.sort(key=lambda e: e[0])
+
+    saida = []
+    abertos = {}  # (núcleo, evento) -> pilha de (início, arg)
+    for t, evento, nucleo, arg in eventos:
+        tipo = evento & 0x3F
+        nome = NOMES[tipo] if tipo < len(NOMES) else f'evento_{tipo}'
+        if evento & FASE_INSTANTE:
+            saida.append({'name': nome, 'ph': 'i', 's': 't', 'ts': t, 'pid': 0, 'tid': nucleo,
+                          'args': {'arg': arg}})
+        elif evento & FASE_FIM:
+            pilha = abertos.get((nucleo, tipo))
+            if not pilha:
+                continue  # o início ficou fora do anel
+            inicio, arg_inicio = pilha.pop()
+            saida.append({'name': nome, 'ph': 'X', 'ts': inicio, 'dur': t - inicio, 'pid': 0, 'tid': nucleo,
+                          'args': {'inicio': arg_inicio, 'fim': arg}})
+        else:
+            abertos.setdefault((nucleo, tipo), []).append((t, arg))
+
+    for nucleo in sorted({e[2] for e in eventos}):
+        saida.append({'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': nucleo,
+                      'args': {'name': f'nucleo {nucleo}'}})
+    return saida
+
+
+if __name__ == '__main__':
+    entrada = sys.argv[1] if len(sys.argv) > 1 else 'Arquivos/trace.bin'
+    saida = sys.argv[2] if len(sys.argv) > 2 else 'Arquivos/trace.json'
+
+    registros = ler_registros(entrada)
+    eventos = converter(registros)
+    with open(saida, 'w') as f:
+        json.dump({'traceEvents': eventos, 'displayTimeUnit': 'ms'}, f)
+
+    # Resumo: piores durações de cada evento (os outliers a investigar)
+    duracoes = {}
+    for e in eventos:
+        if e['ph'] == 'X':
+            duracoes.setdefault(e['name'], []).append(e['dur'])
+    for nome, lista in sorted(duracoes.items()):
+        lista.sort()
+        print(f'{nome:12s} n={len(lista):6d} mediana={lista[len(lista) // 2]:7d} us max={lista[-1]:7d} us')
+    print(f'{len(registros)} registros, {len(eventos)} eventos em {saida}')
@@ -2,13 +2,21 @@
 #include <stdio.h>
 #include "hardware/gpio.h"
 #include "hardware/i2c.h"
+#include "hardware/adc.h"
 #include "lib/ssd1306.h"
 #include "lib/font.h"
-#include "lib/mpu6050.h"
+#include "lib/sensores.h"
+#include "lib/calibracao.h"
+#include "lib/orientacao.h"
+#include "lib/gatilho.h"
+#include "lib/resumo.h"
+#include "lib/config.h"
+#include "lib/diagnostico.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
 #include "queue.h"
+#include "event_groups.h"
 #include "pico/bootrom.h"
 #include <math.h>
 
@@ -18,8 +26,121 @@
 #include "sd_card.h"
 #include "f_util.h"
 #include "my_debug.h"
+#include "lib/lzblock.h"
+#include "lib/bench_sd.h"
+#include "lib/trace.h"
+#include "lib/arena.h"
+#include "lib/caminho_quente.h"
 
+// LOG_COMPRESS = 1: cada bloco de staging cheio é comprimido (lib/lzblock.h)
+// e gravado em dados.lzb; use Arquivos/lzb_decode.py para gerar o CSV.
+#ifndef LOG_COMPRESS
+#define LOG_COMPRESS 0
+#endif
+
+#if LOG_COMPRESS
+static const char *nome_arquivo = "dados.lzb";
+#else
 static const char *nome_arquivo = "dados.csv";
+#endif
+
+static const char *cabecalho_csv = "numero_amostra;sensor;accel_x;accel_y;accel_z;giro_x;giro_y;giro_z\n";
+static const char *cabecalho_orientacao =
+    "numero_amostra;sensor;accel_x;accel_y;accel_z;giro_x;giro_y;giro_z;roll;pitch;yaw\n";
+
+#define BLOCO_TAM 4096 // tamanho do bloco de staging (múltiplo de 512)
+#define RESUMO_BLOCO_TAM 2048 // staging do resumo decimado
+
+// Resumo decimado (resumo_hz no config.ini): sempre CSV, mesmo com LOG_COMPRESS
+#define ARQUIVO_RESUMO "resumo.csv"
+static const char *const eixos_resumo[RESUMO_EIXOS] = {"accel_x", "accel_y", "accel_z", "giro_x", "giro_y", "giro_z"};
+
+#define FILA_AMOSTRAS_TAM 64   // registros em trânsito entre os núcleos (inicial e mínimo)
+#define AMOSTRAS_AREA 2048     // registros da área da arena dividida entre a fila e o pré-disparo (28 KB)
+#define FILA_AMOSTRAS_MAX AMOSTRAS_AREA // teto da fila dimensionada na montagem
+#define FILA_AMOSTRAS_SRAM5 128 // até este tamanho a fila fica no banco SRAM5 (1,75 KB)
+#define AQUECIMENTO_BLOCOS 32  // blocos gravados na montagem para medir o cartão
+#define AQUECIMENTO_MARGEM 2   // a fila cobre N vezes a pior gravação medida
+#define DECIMACAO_GRAFICO 2    // média de N amostras por ponto do gráfico
+#define FILA_GRAFICO_TAM 8     // pontos do gráfico aguardando o display
+#define DISPLAY_PAGINA_MAX_MS 10 // teto do envio de uma página (128 B levam ~3 ms a 400 kHz)
+#define FILA_EVENTOS_TAM 8     // eventos pendentes da máquina de estados
+
+#define CONSOLE_LINHA_TAM 32   // maior comando aceito pelo console USB
+#define TAREFAS_MAX 16         // tarefas acompanhadas pelo comando "tarefas"
+#define LAT_MIN_COMANDOS 50    // escritas no histograma antes de avaliar o p99
+
+#define ESTRESSE_SEGUNDOS 5    // duração de cada taxa do benchmark de estresse
+#define JITTER_SEGUNDOS 10     // duração do benchmark de jitter
+#define CALIB_SEGUNDOS 3       // duração de cada coleta da calibração
+#define CALIB_TAXA_HZ 200      // taxa das coletas da calibração
+#if LOG_COMPRESS
+#define ARQUIVO_ESTRESSE "estresse.lzb"
+#else
+#define ARQUIVO_ESTRESSE "estresse.csv"
+#endif
+
+// Afinidade das tarefas: núcleo 0 faz aquisição e interface, núcleo 1 o armazenamento
+#define NUCLEO_AQUISICAO (1 << 0)
+#define NUCLEO_ARMAZENAMENTO (1 << 1)
+
+// Estados do sistema. Só a vEstadoTask altera o estado atual; as demais
+// tarefas recebem as mudanças pelo grupo de eventos xEventosEstado.
+typedef enum
+{
+    ESTADO_SEM_SD,      // cartão desmontado
+    ESTADO_MONTANDO,    // montagem do cartão em andamento
+    ESTADO_DESMONTANDO, // desmontagem do cartão em andamento
+    ESTADO_PRONTO,      // cartão montado, sensor desligado
+    ESTADO_CAPTURANDO,  // cartão montado, sensor ligado
+    ESTADO_ERRO         // falha ao montar/desmontar o cartão
+} estado_t;
+
+// Eventos que provocam transições de estado
+typedef enum
+{
+    EVENTO_BOTAO_A,     // liga/desliga o sensor
+    EVENTO_BOTAO_B,     // monta/desmonta o cartão
+    EVENTO_MONTADO,     // montagem concluída
+    EVENTO_DESMONTADO,  // desmontagem concluída
+    EVENTO_FALHA_SD     // falha na montagem/desmontagem
+} evento_t;
+
+// Bits do grupo de eventos xEventosEstado
+#define BIT_CAPTURANDO (1 << 0)  // mantido enquanto o estado for ESTADO_CAPTURANDO
+#define BIT_GRAVANDO (1 << 1)    // mantido enquanto um bloco é gravado no SD
+#define BIT_UI_DISPLAY (1 << 2)  // mudança pendente para o display
+#define BIT_UI_LEDS (1 << 3)     // mudança pendente para os LEDs
+#define BITS_UI (BIT_UI_DISPLAY | BIT_UI_LEDS)
+#define BIT_TELA (1 << 4)        // joystick pediu a próxima tela
+#define BIT_CANAL (1 << 5)       // joystick pediu o próximo canal do gráfico
+#define BIT_GRAFICO (1 << 6)     // novo ponto na fila do gráfico
+#define BIT_DIMENSIONAR (1 << 7) // montagem pede à gravação o aquecimento e a nova fila
+#define BIT_FILA_PRONTA (1 << 8) // fila de amostras redimensionada
+#define BIT_CAPTURA_PARADA (1 << 9)  // a captura saiu do laço: nenhuma amostra a caminho da fila
+#define BIT_GRAVACAO_OCIOSA (1 << 10) // a gravação achou a fila vazia sem registro em formatação
+
+// Telas do display
+typedef enum
+{
+    TELA_STATUS,  // estado do sistema
+    TELA_GRAFICO, // forma de onda rolante de um canal
+    TELA_DIAGNOSTICO, // vazão, fila, latência do SD e heap
+    TELA_ORIENTACAO,  // roll, pitch e yaw do primeiro sensor
+    TELA_QTD
+} tela_t;
+
+// Leitura bruta de um sensor enviada da captura para a gravação. Cada
+// período gera uma rajada de registros, um por sensor.
+typedef struct
+{
+    sensor_leitura_t leitura;
+    uint8_t sensor; // identificador fixo do sensor (lib/sensores.h)
+    uint8_t marcas; // MARCA_*
+} amostra_t;
+
+#define MARCA_ULTIMO (1 << 0)    // último registro da rajada: fecha o número da amostra
+#define MARCA_MOVIMENTO (1 << 1) // o sensor sinalizou movimento nesta leitura
 
 #define BOTAO_A 5           // pino do botão A
 #define BOTAO_B 6           // pino do botão B
@@ -27,38 +148,115 @@ static const char *nome_arquivo = "dados.csv";
 #define LED_PIN_BLUE 12     // azul
 #define LED_PIN_RED 13      // vermelho
 #define JOYSTICK_BTN_PIN 22 // pino do botão do joystick
+#define JOYSTICK_X_PIN 26   // eixo do joystick (ADC0): troca a tela do display
+#define JOYSTICK_Y_PIN 27   // eixo do joystick (ADC1): troca o canal do gráfico
 
 #define I2C_PORT i2c0
 #define I2C_SDA 0
 #define I2C_SCL 1
+#define I2C_BAUD_SENSOR (400 * 1000) // máximo do MPU6050 (fast-mode)
 
 // semáforos utilizados
-SemaphoreHandle_t xSemBotaoB;
-
-volatile uint32_t last_time;        // armazena o tempo do último clique nos botões
-volatile bool sensor_state = false; // estado do sensor, inicia desligado
-volatile bool ready = true;         // estado de prontidão do sistema
-volatile bool capture = false;
-volatile bool error = false;
-volatile bool sd_mount = false;
-volatile bool sd_mounting = false;
-volatile bool sd_writing = false;
+SemaphoreHandle_t xSemMontagem; // pedido de montagem/desmontagem para a vMontagemTask
+SemaphoreHandle_t xMutexBloco; // protege o bloco de staging e o acesso ao arquivo
+SemaphoreHandle_t xMutexI2C1;  // i2c1, do display e dos sensores em 0x68/0x69 desse barramento
+QueueHandle_t xFilaAmostras;   // leituras da captura (núcleo 0) para a gravação (núcleo 1)
+static volatile uint32_t fila_capacidade = FILA_AMOSTRAS_TAM; // dimensionada a cada montagem
+QueueHandle_t xFilaEventos;    // eventos para a máquina de estados
+QueueHandle_t xFilaGrafico;    // cópia decimada das amostras para o gráfico
+EventGroupHandle_t xEventosEstado;
+
+// Memória dos objetos acima na arena (lib/arena.h). A fila de amostras usa
+// o início de amostras_area; o que sobra vai para o anel de pré-disparo do
+// gatilho. Filas pequenas ficam no banco SRAM5, longe do DMA do SPI, e
+// deixam a área inteira para o anel.
+static StaticSemaphore_t sem_montagem_mem ARENA;
+static StaticSemaphore_t mutex_bloco_mem ARENA;
+static StaticSemaphore_t mutex_i2c1_mem ARENA;
+static StaticQueue_t fila_amostras_mem ARENA_SRAM5;
+static uint8_t fila_amostras_sram5[FILA_AMOSTRAS_SRAM5 * sizeof(amostra_t)] ARENA_SRAM5;
+static amostra_t amostras_area[AMOSTRAS_AREA] ARENA;
+static StaticQueue_t fila_eventos_mem ARENA;
+static uint8_t fila_eventos_area[FILA_EVENTOS_TAM * sizeof(evento_t)] ARENA;
+static StaticQueue_t fila_grafico_mem ARENA;
+static uint8_t fila_grafico_area[FILA_GRAFICO_TAM * sizeof(amostra_t)] ARENA;
+static StaticEventGroup_t eventos_estado_mem ARENA;
+
+TAREFA_ESTATICA(estado, 256);
+TAREFA_ESTATICA(captura, 512);
+TAREFA_ESTATICA(leds, 256);
+TAREFA_ESTATICA(montagem, 512);
+TAREFA_ESTATICA(display, 512);
+TAREFA_ESTATICA(gravacao, 1024);
+TAREFA_ESTATICA(joystick, 256);
+TAREFA_ESTATICA(console, 1024);
+
+// Bloco de staging: as linhas do CSV são acumuladas aqui e gravadas de uma vez
+static char bloco[BLOCO_TAM] ARENA;
+static size_t bloco_len = 0;
+#if LOG_COMPRESS
+static uint8_t bloco_lz[LZB_BOUND(BLOCO_TAM)] ARENA;
+#endif
+// Arquivo aberto por gravar_bloco e pelo aquecimento (sob xMutexBloco). No
+// SRAM4: seu buffer de setor recebe os trechos parciais que vão pelo DMA do SPI
+static FIL arquivo_log ARENA_SRAM4;
+
+volatile uint32_t last_time;                // armazena o tempo do último clique nos botões
+static volatile estado_t estado = ESTADO_SEM_SD; // estado atual (escrito só pela vEstadoTask)
+static bool sd_montado = false;               // cartão montado (usado na saída do estado de erro)
 volatile int numero_amostra = 0;
 
+diagnostico_t diag; // lib/diagnostico.h
+
+// Benchmark de jitter: variação do período da captura e duração de cada
+// leitura, nos histogramas log2 de sd_latencia.h, enquanto medindo_jitter
+static volatile bool medindo_jitter = false;
+static sd_latencia_t jitter_periodo, jitter_leitura;
+
+// Taxa da captura em andamento (ou da última), se ela saiu em lotes por
+// tick (acima do tick, sem alarme de hardware livre), e aviso de cartão
+// lento já dado
+static volatile uint16_t taxa_captura = 0;
+static volatile bool captura_em_lotes = false;
+static volatile bool aviso_cartao_lento = false;
+
+// Configuração da captura (config.ini), lida a cada montagem do cartão
+static config_t config;
+
+// Orientação (orientacao = 1): o filtro de cada sensor roda na gravação
+// (núcleo 1), antes da formatação, e recomeça a cada captura
+static orientacao_t orientacoes[SENSORES_MAX];
+static uint32_t sessao_orientacao[SENSORES_MAX]; // captura a que o filtro do sensor pertence
+static volatile uint32_t sessao_captura = 0;      // incrementada no início de cada captura
+static volatile int16_t angulos_tela[3];           // último roll, pitch e yaw do primeiro sensor
+
+// Gatilho de evento ([gatilho] no config.ini): fora de um evento a gravação
+// guarda os registros neste anel, sem formatar, e no disparo descarrega os
+// últimos pre_ms antes do próprio registro. O anel é a parte de
+// amostras_area que a fila não usa, refeita a cada dimensionamento.
+static amostra_t *pre_gatilho = amostras_area;
+static unsigned pre_gatilho_max = AMOSTRAS_AREA;
+volatile uint32_t registros_omitidos = 0; // registros numerados mas fora dos eventos gravados
+
+// Resumo decimado: calculado na gravação com todas as leituras, inclusive as
+// que o gatilho deixa fora do log, e acumulado em um staging próprio (sob
+// xMutexBloco, como o do log) gravado em ARQUIVO_RESUMO
+static resumo_t resumos[SENSORES_MAX] ARENA;
+static char bloco_resumo[RESUMO_BLOCO_TAM] ARENA;
+static size_t bloco_resumo_len = 0;
+static uint32_t sessao_resumo = 0;   // captura a que os resumos pertencem
+static bool resumo_pendente = false; // a captura deixou períodos por sair
+
 void gpio_irq_handler(uint gpio, uint32_t events)
 {
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
     if (current_time - last_time > 200)
     {
-        if (gpio == BOTAO_A) // Se o botão estiver pressionado
-        {
-            sensor_state = !sensor_state; // Alterna o estado do sensor
-        }
-
-        else if (gpio == BOTAO_B) // Se o botão estiver pressionado
+        if (gpio == BOTAO_A || gpio == BOTAO_B) // Se o botão estiver pressionado
         {
+            evento_t evento = (gpio == BOTAO_A) ? EVENTO_BOTAO_A : EVENTO_BOTAO_B;
             BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-            xSemaphoreGiveFromISR(xSemBotaoB, &xHigherPriorityTaskWoken);
+            xQueueSendFromISR(xFilaEventos, &evento, &xHigherPriorityTaskWoken);
             portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
         }
         else if (gpio == JOYSTICK_BTN_PIN) // Se o botão estiver pressionado
@@ -78,193 +276,1197 @@ static sd_card_t *sd_get_by_name(const char *const name)
     return NULL;
 }
 
-void vCapturaTask(void *params)
+// Publica o novo estado e acorda as tarefas que dependem dele
+static void publicar_estado(estado_t novo)
 {
-    // Inicializa I2C
-    i2c_init(I2C_PORT, 400 * 1000); // 400kHz
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
+    estado = novo;
+    if (novo == ESTADO_CAPTURANDO)
+    {
+        xEventGroupClearBits(xEventosEstado, BIT_CAPTURA_PARADA);
+        xEventGroupSetBits(xEventosEstado, BIT_CAPTURANDO | BITS_UI);
+    }
+    else
+    {
+        xEventGroupClearBits(xEventosEstado, BIT_CAPTURANDO);
+        xEventGroupSetBits(xEventosEstado, BITS_UI);
+    }
+}
 
-    // Inicializa MPU6050
-    mpu6050_init(I2C_PORT, MPU6050_DEFAULT_ADDR);
-    mpu6050_reset(I2C_PORT, MPU6050_DEFAULT_ADDR);
+// Tabela de transições da máquina de estados
+static estado_t proximo_estado(estado_t atual, evento_t evento)
+{
+    switch (evento)
+    {
+    case EVENTO_BOTAO_A:
+        if (atual == ESTADO_PRONTO)
+            return ESTADO_CAPTURANDO;
+        if (atual == ESTADO_CAPTURANDO)
+            return ESTADO_PRONTO;
+        break;
+    case EVENTO_BOTAO_B:
+        if (atual == ESTADO_SEM_SD || (atual == ESTADO_ERRO && !sd_montado))
+            return ESTADO_MONTANDO;
+        if (atual == ESTADO_PRONTO || atual == ESTADO_CAPTURANDO || atual == ESTADO_ERRO)
+            return ESTADO_DESMONTANDO;
+        break;
+    case EVENTO_MONTADO:
+        sd_montado = true;
+        return ESTADO_PRONTO;
+    case EVENTO_DESMONTADO:
+        sd_montado = false;
+        return ESTADO_SEM_SD;
+    case EVENTO_FALHA_SD:
+        return ESTADO_ERRO;
+    }
+    return atual; // evento ignorado no estado atual
+}
 
-    int16_t acel[3], giro[3], temp;
+// Única tarefa que altera o estado: as transições são serializadas pela fila
+void vEstadoTask(void *params)
+{
+    evento_t evento;
     while (true)
     {
+        if (xQueueReceive(xFilaEventos, &evento, portMAX_DELAY) != pdTRUE)
+            continue;
 
-        if (sensor_state && sd_mount && ready)
-        {
-            ready = false;  // Indica que o sistema não está pronto para capturar dados
-            capture = true; // Alterna o estado de captura
+        estado_t novo = proximo_estado(estado, evento);
+        if (novo == estado)
+            continue;
 
-            mpu6050_read_raw(I2C_PORT, MPU6050_DEFAULT_ADDR, acel, giro, &temp);
+        publicar_estado(novo);
+        if (novo == ESTADO_MONTANDO || novo == ESTADO_DESMONTANDO)
+            xSemaphoreGive(xSemMontagem); // a vMontagemTask executa a operação
+    }
+}
 
-            // --- Cálculos para Acelerômetro ---
-            float ax = acel[0] / 16384.0f;
-            float ay = acel[1] / 16384.0f;
-            float az = acel[2] / 16384.0f;
+// Envia um evento para a máquina de estados a partir de uma tarefa
+static void enviar_evento(evento_t evento)
+{
+    xQueueSend(xFilaEventos, &evento, portMAX_DELAY);
+}
 
-            // --- Cálculos para Giroscópio ---
-            float gx = giro[0] / 131.0f;
-            float gy = giro[1] / 131.0f;
-            float gz = giro[2] / 131.0f;
+// Registros por período: um por sensor ativo (ao menos um, nas contas da fila)
+static unsigned registros_por_rajada(void)
+{
+    unsigned n = sensores_qtd();
+    return n ? n : 1;
+}
 
-            float temp_c = (temp / 340.0f) + 15.0f;
+// Tempo que a fila de amostras cobre na taxa atual: uma escrita do cartão
+// mais longa que isso faz a captura descartar amostras
+static uint32_t folga_fila_us(uint16_t taxa)
+{
+    uint32_t registros_s = (uint32_t)taxa * registros_por_rajada();
+    return registros_s ? (uint32_t)(fila_capacidade * 1000000ull / registros_s) : UINT32_MAX;
+}
 
-            printf("Acel: X=%.2fg Y=%.2fg Z=%.2fg\n", ax, ay, az);
-            printf("Giro: X=%.2f°/s Y=%.2f°/s Z=%.2f°/s\n", gx, gy, gz);
-            printf("Temp: %.2f °C\n", temp_c);
-            printf("---------------------------\n");
+// Avisa (uma vez por captura) quando o p99 das escritas passa da folga da fila
+static void verificar_cartao_lento(void)
+{
+    const sd_latencia_t *lat = &sd_get_by_num(0)->lat_escrita;
+    if (aviso_cartao_lento || lat->comandos < LAT_MIN_COMANDOS)
+        return;
+    uint32_t p99 = sd_latencia_percentil(lat, 990);
+    if (p99 > folga_fila_us(taxa_captura))
+    {
+        aviso_cartao_lento = true;
+        printf("[AVISO] Cartão lento para %u Hz: p99 da escrita %lu us > folga da fila %lu us\n", taxa_captura,
+               (unsigned long)p99, (unsigned long)folga_fila_us(taxa_captura));
+    }
+}
 
-            vTaskDelay(pdMS_TO_TICKS(500)); // Delay to avoid flooding the output
+// Grava o conteúdo do bloco de staging no cartão (comprimido se LOG_COMPRESS)
+// Deve ser chamada com xMutexBloco obtido.
+static bool CAMINHO_QUENTE(gravar_bloco)(void)
+{
+    if (bloco_len == 0)
+        return true;
 
-            capture = false; // Alterna o estado de captura
+    xEventGroupSetBits(xEventosEstado, BIT_GRAVANDO | BITS_UI); // Indica que o sistema está escrevendo no SD
 
-            sd_writing = true; // Indica que o sistema está escrevendo no SD
+    const void *dados = bloco;
+    UINT tamanho = bloco_len;
+#if LOG_COMPRESS
+    tamanho = lzb_encode_block((const uint8_t *)bloco, bloco_len, bloco_lz, sizeof(bloco_lz));
+    dados = bloco_lz;
+#endif
+    TRACE_MARCA(TRACE_BLOCO, tamanho);
 
-            // --- Escreve os dados no SD ---
-            FIL file;
-            FRESULT fr;
+    uint32_t inicio = time_us_32();
+    TRACE_INICIO(TRACE_GRAVACAO, tamanho);
+    FRESULT fr = f_open(&arquivo_log, nome_arquivo, FA_WRITE | FA_OPEN_APPEND);
+    if (fr != FR_OK)
+    {
+        TRACE_FIM(TRACE_GRAVACAO, 0);
+        printf("[ERRO] Falha ao abrir o arquivo: %d\n", fr);
+        xEventGroupClearBits(xEventosEstado, BIT_GRAVANDO);
+        xEventGroupSetBits(xEventosEstado, BITS_UI);
+        return false;
+    }
 
-            fr = f_open(&file, nome_arquivo, FA_WRITE | FA_OPEN_APPEND);
-            if (fr == FR_OK)
-            {
-                char linha[128];
-                snprintf(linha, sizeof(linha), "%d;%.2f;%.2f;%.2f;%.2f;%.2f;%.2f\n",
-                         numero_amostra, ax, ay, az, gx, gy, gz);
+    UINT bw;
+    fr = f_write(&arquivo_log, dados, tamanho, &bw);
+    TRACE_INICIO(TRACE_SYNC, 0);
+    f_close(&arquivo_log);
+    TRACE_FIM(TRACE_SYNC, 0);
+    TRACE_FIM(TRACE_GRAVACAO, bw);
 
-                UINT bw;
-                fr = f_write(&file, linha, strlen(linha), &bw);
+    uint32_t latencia = time_us_32() - inicio;
+    diag.lat_ultima_us = latencia;
+    if (latencia > diag.lat_max_us)
+        diag.lat_max_us = latencia;
+    diag.bytes_gravados += bw;
 
-                if (fr == FR_OK)
-                {
-                    // Incrementa o numero_amostra ador de leituras
-                    numero_amostra++;
-                }
-                else
-                {
-                    printf("[ERRO] Falha ao escrever no arquivo: %d\n", fr);
-                }
+    xEventGroupClearBits(xEventosEstado, BIT_GRAVANDO); // Indica que o sistema terminou de escrever no SD
+    xEventGroupSetBits(xEventosEstado, BITS_UI);
+    if (fr != FR_OK || bw != tamanho)
+    {
+        printf("[ERRO] Falha ao escrever no arquivo: %d\n", fr);
+        return false;
+    }
 
-                f_close(&file);
-            }
-            else
-            {
-                printf("[ERRO] Falha ao abrir o arquivo: %d\n", fr);
-            }
+    bloco_len = 0;
+    if (estado == ESTADO_CAPTURANDO)
+        verificar_cartao_lento();
+    return true;
+}
+
+// Acrescenta uma linha ao bloco de staging, gravando-o antes se estiver cheio
+static bool CAMINHO_QUENTE(adicionar_linha)(const char *linha, size_t len)
+{
+    bool ok = true;
+    xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+    if (bloco_len + len > BLOCO_TAM)
+        ok = gravar_bloco();
+    if (ok)
+    {
+        memcpy(&bloco[bloco_len], linha, len);
+        bloco_len += len;
+    }
+    xSemaphoreGive(xMutexBloco);
+    return ok;
+}
 
-            // --- Finaliza a escrita no SD ---
-            printf("[SD] Dados gravados no arquivo %s\n", nome_arquivo);
-            vTaskDelay(pdMS_TO_TICKS(500)); // Delay to avoid flooding the output
+// Grava o bloco parcial (fim da captura ou desmontagem do cartão)
+static void descarregar_bloco(void)
+{
+    xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+    gravar_bloco();
+    xSemaphoreGive(xMutexBloco);
+}
 
-            sd_writing = false; // Indica que o sistema terminou de escrever no SD
-            ready = true;       // Indica que o sistema está pronto para capturar dados
+// Espera a captura sair do laço (nada mais a caminho da fila) e a gravação
+// processar tudo o que recebeu. O pedido apaga BIT_GRAVACAO_OCIOSA; a
+// gravação só o acende de novo ao achar a fila vazia, depois de terminar o
+// último registro retirado dela.
+static void esperar_gravacao_ociosa(void)
+{
+    xEventGroupWaitBits(xEventosEstado, BIT_CAPTURA_PARADA, pdFALSE, pdFALSE, portMAX_DELAY);
+    xEventGroupClearBits(xEventosEstado, BIT_GRAVACAO_OCIOSA);
+    xEventGroupWaitBits(xEventosEstado, BIT_GRAVACAO_OCIOSA, pdFALSE, pdFALSE, portMAX_DELAY);
+}
 
-            vTaskDelay(pdMS_TO_TICKS(1000)); // Delay to avoid flooding the output
-        }
-        vTaskDelay(pdMS_TO_TICKS(100)); // Delay to avoid flooding the output
+// Grava o staging do resumo em ARQUIVO_RESUMO. Deve ser chamada com
+// xMutexBloco obtido.
+static bool gravar_resumo(void)
+{
+    if (bloco_resumo_len == 0)
+        return true;
+
+    xEventGroupSetBits(xEventosEstado, BIT_GRAVANDO | BITS_UI);
+    UINT bw = 0;
+    FRESULT fr = f_open(&arquivo_log, ARQUIVO_RESUMO, FA_WRITE | FA_OPEN_APPEND);
+    if (fr == FR_OK)
+    {
+        fr = f_write(&arquivo_log, bloco_resumo, bloco_resumo_len, &bw);
+        f_close(&arquivo_log);
+    }
+    diag.bytes_gravados += bw;
+    xEventGroupClearBits(xEventosEstado, BIT_GRAVANDO);
+    xEventGroupSetBits(xEventosEstado, BITS_UI);
+    if (fr != FR_OK || bw != bloco_resumo_len)
+    {
+        printf("[ERRO] Falha ao gravar %s: %d\n", ARQUIVO_RESUMO, fr);
+        return false;
     }
+
+    bloco_resumo_len = 0;
+    return true;
 }
 
-void vLedsTask(void *params)
+// Acrescenta uma linha ao staging do resumo, gravando-o antes se estiver cheio
+static bool adicionar_linha_resumo(const char *linha, size_t len)
 {
+    bool ok = true;
+    xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+    if (bloco_resumo_len + len > RESUMO_BLOCO_TAM)
+        ok = gravar_resumo();
+    if (ok)
+    {
+        memcpy(&bloco_resumo[bloco_resumo_len], linha, len);
+        bloco_resumo_len += len;
+    }
+    xSemaphoreGive(xMutexBloco);
+    return ok;
+}
+
+// Grava o staging parcial do resumo
+static void descarregar_resumo(void)
+{
+    xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+    gravar_resumo();
+    xSemaphoreGive(xMutexBloco);
+}
+
+// Reserva o i2c1 para os sensores: espera no máximo a página do display em
+// andamento
+static void reservar_i2c1(void)
+{
+    xSemaphoreTake(xMutexI2C1, portMAX_DELAY);
+}
 
+static void liberar_i2c1(void)
+{
+    xSemaphoreGive(xMutexI2C1);
+}
+
+// Inicializa o i2c0 e procura os sensores nos dois barramentos. O i2c1 é
+// (re)inicializado aqui sob o mutex: o display pode ainda não ter feito isso.
+static void iniciar_sensores(void)
+{
+    i2c_init(I2C_PORT, I2C_BAUD_SENSOR);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+
+    xSemaphoreTake(xMutexI2C1, portMAX_DELAY);
+    i2c_init(I2C_PORT_DISP, I2C_BAUD_SENSOR);
+    gpio_set_function(I2C_SDA_DISP, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL_DISP, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA_DISP);
+    gpio_pull_up(I2C_SCL_DISP);
+    sensores_detectar(true);
+    i2c_set_baudrate(I2C_PORT_DISP, I2C_BAUD_DISP);
+    liberar_i2c1();
+}
+
+static repeating_timer_t alarme_periodo; // período da captura acima do tick
+
+// Alarme de hardware do período da captura (IRQ): acorda a captura
+static bool CAMINHO_QUENTE(alarme_captura)(repeating_timer_t *t)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)t->user_data, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    return true;
+}
+
+// Núcleo 0: aquisição e interface. Lê os sensores no período configurado,
+// todos em rajada, e entrega as leituras brutas à tarefa de gravação pela
+// fila de amostras.
+void CAMINHO_QUENTE(vCapturaTask)(void *params)
+{
+    iniciar_sensores();
+
+    amostra_t amostra;
     while (true)
     {
-        gpio_put(LED_PIN_GREEN, false);
-        gpio_put(LED_PIN_BLUE, false);
-        gpio_put(LED_PIN_RED, false);
+        // Dorme até o estado passar para ESTADO_CAPTURANDO
+        xEventGroupWaitBits(xEventosEstado, BIT_CAPTURANDO, pdFALSE, pdFALSE, portMAX_DELAY);
 
-        if (ready)
+        // Com sensores no i2c1 a captura reserva o barramento só para a
+        // configuração e para cada rajada: entre as rajadas o display envia
+        // o quadro, uma página por vez. O clock fica no do MPU6050
+        // (fast-mode) até a captura parar, também para o display: trocá-lo
+        // desabilita o controlador, então não acontece a cada rajada.
+        bool usa_i2c1 = sensores_no_i2c1();
+        if (usa_i2c1)
         {
-            gpio_put(LED_PIN_GREEN, true); // Liga o LED verde
+            reservar_i2c1();
+            i2c_set_baudrate(I2C_PORT_DISP, I2C_BAUD_SENSOR);
         }
-        else if (capture)
+
+        // Aplica a configuração vigente (pode ter mudado na última montagem)
+        sensor_config_t cfg_sensor = {config.taxa_hz, config.dlpf, config.acel_g, config.giro_dps,
+                                      config.gatilho == GATILHO_MOVIMENTO ? config.limiar_mg : 0};
+        uint16_t taxa = sensores_configurar(&cfg_sensor);
+        for (unsigned s = 0; s < sensores_qtd(); s++)
+            calibracao_preparar(sensores_obter(s));
+        if (usa_i2c1)
+            liberar_i2c1();
+        // O divisor do MPU6050 tem 8 bits (sem DLPF a taxa mínima é 31,25 Hz):
+        // lê na taxa pedida sempre que os sensores forem pelo menos tão rápidos
+        if (config.taxa_hz > 0 && config.taxa_hz < taxa)
+            taxa = config.taxa_hz;
+        // Acima da frequência do tick (1 kHz) um alarme de hardware marca o
+        // período e acorda a captura por notificação. Sem alarme livre o
+        // período fica em um tick e cada período faz várias rajadas seguidas
+        // (taxa arredondada ao múltiplo do tick): a média se mantém, mas as
+        // leituras saem em lotes.
+        TickType_t periodo = configTICK_RATE_HZ / taxa;
+        uint16_t lote = 1;
+        uint32_t periodo_us = periodo * (1000000 / configTICK_RATE_HZ);
+        bool alarme = false;
+        if (periodo == 0)
         {
-            gpio_put(LED_PIN_RED, true); // Liga o LED vermelho
+            periodo = 1;
+            periodo_us = 1000000 / taxa;
+            ulTaskNotifyTake(pdTRUE, 0);
+            alarme = add_repeating_timer_us(-(int64_t)periodo_us, alarme_captura, xTaskGetCurrentTaskHandle(),
+                                            &alarme_periodo);
+            if (!alarme)
+            {
+                lote = (taxa + configTICK_RATE_HZ / 2) / configTICK_RATE_HZ;
+                periodo_us = 1000000 / configTICK_RATE_HZ;
+            }
         }
-        else if (error)
+        captura_em_lotes = lote > 1;
+        taxa_captura = alarme ? 1000000 / periodo_us : lote * configTICK_RATE_HZ / periodo;
+        sessao_captura++;
+        aviso_cartao_lento = false;
+        unsigned n_sensores = sensores_qtd();
+        sensor_leitura_t ultimas[SENSORES_MAX] = {0}; // sem resposta, o registro repete a anterior
+
+        int32_t soma[6] = {0}; // acumuladores da média do gráfico (primeiro sensor)
+        int n_soma = 0;
+        TickType_t ultimo = xTaskGetTickCount();
+        uint32_t despertar_anterior = 0;
+        bool primeiro = true;
+        while (xEventGroupGetBits(xEventosEstado) & BIT_CAPTURANDO)
         {
-            gpio_put(LED_PIN_BLUE, true);   // Liga o LED azul
-            gpio_put(LED_PIN_RED, true);    // Liga o LED vermelho
-            vTaskDelay(pdMS_TO_TICKS(200)); // Delay para evitar flooding
-            gpio_put(LED_PIN_BLUE, false);  // Desliga o LED azul
-            gpio_put(LED_PIN_RED, false);   // Desliga o LED vermelho
+            uint32_t inicio = time_us_32();
+            // Jitter: distância entre dois despertares comparada ao período
+            if (medindo_jitter && !primeiro)
+            {
+                uint32_t intervalo = inicio - despertar_anterior;
+                sd_latencia_registrar(&jitter_periodo,
+                                      intervalo > periodo_us ? intervalo - periodo_us : periodo_us - intervalo, 0);
+            }
+            despertar_anterior = inicio;
+            primeiro = false;
+
+            for (uint16_t k = 0; k < lote; k++)
+            {
+                // Rajada: um registro por sensor, na ordem dos identificadores
+                TRACE_INICIO(TRACE_LEITURA, k);
+                uint32_t inicio_leitura = time_us_32();
+                if (usa_i2c1)
+                    reservar_i2c1();
+                for (unsigned s = 0; s < n_sensores; s++)
+                {
+                    uint8_t id = sensores_obter(s)->id;
+                    if (sensores_ler(s, &ultimas[s], 1) == 0)
+                        diag.leituras_falhas++;
+                    calibracao_acumular(id, &ultimas[s]); // só durante o comando calibrar
+                    amostra.leitura = ultimas[s];
+                    calibracao_aplicar(id, &amostra.leitura);
+                    amostra.sensor = id;
+                    amostra.marcas = s == n_sensores - 1 ? MARCA_ULTIMO : 0;
+                    if (sensores_obter(s)->movimento)
+                        amostra.marcas |= MARCA_MOVIMENTO;
+
+                    // Não bloqueia a aquisição se a gravação atrasar: o registro é descartado
+                    diag.amostras_lidas++;
+                    if (xQueueSend(xFilaAmostras, &amostra, 0) != pdTRUE)
+                        diag.amostras_perdidas++;
+
+                    if (s == 0)
+                    {
+                        for (int i = 0; i < 3; i++)
+                        {
+                            soma[i] += amostra.leitura.acel[i];
+                            soma[i + 3] += amostra.leitura.giro[i];
+                        }
+                    }
+                }
+                if (usa_i2c1)
+                    liberar_i2c1();
+                if (medindo_jitter)
+                    sd_latencia_registrar(&jitter_leitura, time_us_32() - inicio_leitura, 0);
+                TRACE_FIM(TRACE_LEITURA, k);
+
+                UBaseType_t ocupacao = uxQueueMessagesWaiting(xFilaAmostras);
+                TRACE_MARCA(TRACE_FILA, ocupacao);
+                if (ocupacao > diag.fila_max)
+                    diag.fila_max = ocupacao;
+
+                // Cópia decimada (média de DECIMACAO_GRAFICO rajadas) do primeiro sensor para o display
+                if (n_sensores > 0 && ++n_soma == DECIMACAO_GRAFICO)
+                {
+                    amostra_t ponto;
+                    for (int i = 0; i < 3; i++)
+                    {
+                        ponto.leitura.acel[i] = soma[i] / DECIMACAO_GRAFICO;
+                        ponto.leitura.giro[i] = soma[i + 3] / DECIMACAO_GRAFICO;
+                        soma[i] = soma[i + 3] = 0;
+                    }
+                    n_soma = 0;
+                    if (xQueueSend(xFilaGrafico, &ponto, 0) == pdTRUE)
+                        xEventGroupSetBits(xEventosEstado, BIT_GRAFICO);
+                }
+            }
+            // Rajadas mais longas que o período: a aquisição não acompanha a taxa
+            uint32_t ocupado = time_us_32() - inicio;
+            diag.tempo_captura_us += ocupado;
+            if (ocupado > periodo_us)
+                diag.periodos_atrasados++;
+
+            if (alarme)
+            {
+                // Mais de um alarme acumulado: períodos inteiros sem rajada
+                uint32_t alarmes = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+                if (alarmes > 1)
+                    diag.periodos_atrasados += alarmes - 1;
+            }
+            else
+                vTaskDelayUntil(&ultimo, periodo);
         }
-        else if (sd_mounting)
+        if (alarme)
+            cancel_repeating_timer(&alarme_periodo);
+
+        if (usa_i2c1)
         {
-            gpio_put(LED_PIN_RED, true);   // Liga o LED vermelho
-            gpio_put(LED_PIN_GREEN, true); // Liga o LED verde
+            reservar_i2c1();
+            i2c_set_baudrate(I2C_PORT_DISP, I2C_BAUD_DISP);
+            liberar_i2c1();
         }
-        else if (sd_writing)
+        xEventGroupSetBits(xEventosEstado, BIT_CAPTURA_PARADA);
+        if (diag.leituras_falhas)
+            printf("[SENSOR] %lu leituras sem resposta desde o boot\n", (unsigned long)diag.leituras_falhas);
+    }
+}
+
+// Aquecimento: grava AQUECIMENTO_BLOCOS blocos do tamanho do staging do mesmo
+// jeito que a gravar_bloco (abre, anexa, fecha) e devolve a pior duração em µs
+static uint32_t medir_pior_gravacao(void)
+{
+    static const char *arquivo = "aquec.tmp";
+    uint32_t pior = 0;
+
+    xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+    for (int i = 0; i < AQUECIMENTO_BLOCOS; i++)
+    {
+        uint32_t inicio = time_us_32();
+        UINT bw;
+        FRESULT fr = f_open(&arquivo_log, arquivo, FA_WRITE | FA_OPEN_APPEND);
+        if (fr == FR_OK)
         {
-            gpio_put(LED_PIN_BLUE, true);   // Liga o LED azul
-            vTaskDelay(pdMS_TO_TICKS(200)); // Delay para evitar flooding
-            gpio_put(LED_PIN_BLUE, false);  // Desliga o LED azul
+            fr = f_write(&arquivo_log, bloco, BLOCO_TAM, &bw); // o conteúdo não importa
+            f_close(&arquivo_log);
         }
-        vTaskDelay(pdMS_TO_TICKS(100)); // Delay para evitar flooding
+        if (fr != FR_OK)
+            break;
+        uint32_t latencia = time_us_32() - inicio;
+        if (latencia > pior)
+            pior = latencia;
     }
+    f_unlink(arquivo);
+    xSemaphoreGive(xMutexBloco);
+    return pior;
 }
 
-void vDisplayTask(void *params)
+// Cria a fila de amostras sobre a área estática: no SRAM5 se couber, senão
+// no início de amostras_area, e entrega o resto da área ao pré-disparo
+static QueueHandle_t criar_fila_amostras(uint32_t capacidade)
 {
-    ssd1306_t ssd;
-    init_Display(&ssd);
+    if (capacidade <= FILA_AMOSTRAS_SRAM5)
+    {
+        pre_gatilho = amostras_area;
+        pre_gatilho_max = AMOSTRAS_AREA;
+        return xQueueCreateStatic(capacidade, sizeof(amostra_t), fila_amostras_sram5, &fila_amostras_mem);
+    }
+    pre_gatilho = amostras_area + capacidade;
+    pre_gatilho_max = AMOSTRAS_AREA - capacidade;
+    return xQueueCreateStatic(capacidade, sizeof(amostra_t), (uint8_t *)amostras_area, &fila_amostras_mem);
+}
 
-    while (true)
+// Dimensiona a fila de amostras para cobrir AQUECIMENTO_MARGEM vezes a pior
+// gravação medida na taxa do config.ini (um registro por sensor), entre FILA_AMOSTRAS_TAM e
+// FILA_AMOSTRAS_MAX (toda a amostras_area). Roda na gravação, única
+// tarefa que espera na fila, com a captura parada.
+static void dimensionar_fila(void)
+{
+    uint32_t pior_us = medir_pior_gravacao();
+    uint32_t taxa = config.taxa_hz ? config.taxa_hz : 1;
+    uint32_t registros_s = taxa * registros_por_rajada();
+    uint32_t necessaria = (uint32_t)((uint64_t)pior_us * AQUECIMENTO_MARGEM * registros_s / 1000000) + 1;
+
+    uint32_t capacidade = necessaria;
+    if (capacidade < FILA_AMOSTRAS_TAM)
+        capacidade = FILA_AMOSTRAS_TAM;
+    if (capacidade > FILA_AMOSTRAS_MAX)
+        capacidade = FILA_AMOSTRAS_MAX;
+
+    if (capacidade != fila_capacidade)
+    {
+        vQueueDelete(xFilaAmostras);
+        xFilaAmostras = criar_fila_amostras(capacidade);
+        fila_capacidade = capacidade;
+    }
+
+    printf("[FILA] Pior gravação no aquecimento: %lu us (%d blocos)\n", (unsigned long)pior_us, AQUECIMENTO_BLOCOS);
+    printf("[FILA] %lu registros (%lu bytes) cobrem %lu ms a %lu Hz com %u sensor(es)%s\n", (unsigned long)capacidade,
+           (unsigned long)(capacidade * sizeof(amostra_t)), (unsigned long)(capacidade * 1000 / registros_s),
+           (unsigned long)taxa, registros_por_rajada(), necessaria > capacidade ? " (LIMITADA: pode perder amostras)" : "");
+    printf("[FILA] Pré-disparo do gatilho: até %u registros\n", pre_gatilho_max);
+}
+
+// Pede à gravação o aquecimento e a fila para config.taxa_hz e espera a
+// fila nova. A captura deve estar parada.
+static void redimensionar_fila(void)
+{
+    xEventGroupClearBits(xEventosEstado, BIT_FILA_PRONTA);
+    xEventGroupSetBits(xEventosEstado, BIT_DIMENSIONAR);
+    xEventGroupWaitBits(xEventosEstado, BIT_FILA_PRONTA, pdTRUE, pdFALSE, portMAX_DELAY);
+}
+
+// Formata um registro com o número de amostra dado e o acumula no bloco de
+// staging. Retorna false se o bloco não pôde ser gravado.
+static bool CAMINHO_QUENTE(gravar_registro)(const amostra_t *amostra, int numero)
+{
+    // --- Orientação: filtro do sensor, reiniciado na primeira amostra de cada captura ---
+    int16_t angulos[3];
+    if (config.orientacao)
+    {
+        unsigned id = amostra->sensor % SENSORES_MAX;
+        if (sessao_orientacao[id] != sessao_captura)
+        {
+            float escala_acel, escala_giro;
+            sensores_escalas(amostra->sensor, &escala_acel, &escala_giro);
+            orientacao_iniciar(&orientacoes[id], escala_acel, escala_giro, taxa_captura);
+            sessao_orientacao[id] = sessao_captura;
+        }
+        orientacao_atualizar(&orientacoes[id], &amostra->leitura, angulos);
+        if (amostra->sensor == sensores_obter(0)->id)
+            for (int i = 0; i < 3; i++)
+                angulos_tela[i] = angulos[i];
+    }
+
+    char linha[128];
+    int len;
+    if (config.formato == FORMATO_BRUTO)
+    {
+        // --- Leituras brutas, sem conversão ---
+        len = snprintf(linha, sizeof(linha), "%d;%u;%d;%d;%d;%d;%d;%d", numero, amostra->sensor,
+                       amostra->leitura.acel[0], amostra->leitura.acel[1], amostra->leitura.acel[2],
+                       amostra->leitura.giro[0], amostra->leitura.giro[1], amostra->leitura.giro[2]);
+    }
+    else
+    {
+        // --- Escalas do driver do sensor na configuração efetiva ---
+        float escala_acel, escala_giro;
+        sensores_escalas(amostra->sensor, &escala_acel, &escala_giro);
+
+        float ax = amostra->leitura.acel[0] / escala_acel;
+        float ay = amostra->leitura.acel[1] / escala_acel;
+        float az = amostra->leitura.acel[2] / escala_acel;
+
+        float gx = amostra->leitura.giro[0] / escala_giro;
+        float gy = amostra->leitura.giro[1] / escala_giro;
+        float gz = amostra->leitura.giro[2] / escala_giro;
+
+        len = snprintf(linha, sizeof(linha), "%d;%u;%.2f;%.2f;%.2f;%.2f;%.2f;%.2f", numero, amostra->sensor, ax,
+                       ay, az, gx, gy, gz);
+    }
+    if (config.orientacao && config.formato == FORMATO_BRUTO)
+        len += snprintf(linha + len, sizeof(linha) - len, ";%d;%d;%d", angulos[0], angulos[1], angulos[2]);
+    else if (config.orientacao)
+        len += snprintf(linha + len, sizeof(linha) - len, ";%.2f;%.2f;%.2f", angulos[0] / 100.0f,
+                        angulos[1] / 100.0f, angulos[2] / 100.0f);
+    linha[len++] = '\n';
+
+    // --- Acumula o registro no bloco de staging ---
+    if (!adicionar_linha(linha, len))
+        return false;
+    diag.registros_gravados++;
+    return true;
+}
+
+// Estado do gatilho de evento, só da gravação
+typedef struct
+{
+    uint32_t sessao;       // captura a que o estado pertence
+    unsigned inicio, qtd;  // registros guardados no anel de pré-disparo
+    unsigned ultimos;      // quantos deles fecham uma rajada
+    unsigned pre_max;      // pre_ms em registros, limitado a pre_gatilho_max
+    uint32_t pos_rajadas;  // pos_ms em rajadas
+    uint32_t pos_restantes; // rajadas que ainda faltam gravar no evento
+    bool em_evento;
+} gatilho_estado_t;
+
+// Recomeça o gatilho no início de uma captura, com as escalas e a taxa dela
+static void gatilho_reiniciar(gatilho_estado_t *g)
+{
+    g->sessao = sessao_captura;
+    g->inicio = g->qtd = g->ultimos = 0;
+    g->em_evento = false;
+
+    uint32_t pre = (uint32_t)config.pre_ms * taxa_captura * registros_por_rajada() / 1000;
+    g->pre_max = pre > pre_gatilho_max ? pre_gatilho_max : pre;
+    g->pos_rajadas = (uint32_t)config.pos_ms * taxa_captura / 1000;
+    for (unsigned s = 0; s < sensores_qtd(); s++)
     {
-        ssd1306_fill(&ssd, false); // Limpa a tela
+        float escala_acel, escala_giro;
+        const sensor_t *sensor = sensores_obter(s);
+        sensores_escalas(sensor->id, &escala_acel, &escala_giro);
+        gatilho_preparar(sensor->id, &config, escala_acel, escala_giro);
+    }
+}
+
+// Fora de um evento: guarda o registro no anel (o mais antigo sai se cheio)
+static void CAMINHO_QUENTE(gatilho_guardar)(gatilho_estado_t *g, const amostra_t *amostra)
+{
+    registros_omitidos++;
+    if (g->pre_max == 0)
+        return;
+    if (g->qtd == g->pre_max)
+    {
+        if (pre_gatilho[g->inicio].marcas & MARCA_ULTIMO)
+            g->ultimos--;
+        g->inicio = (g->inicio + 1) % g->pre_max;
+        g->qtd--;
+    }
+    pre_gatilho[(g->inicio + g->qtd) % g->pre_max] = *amostra;
+    g->qtd++;
+    if (amostra->marcas & MARCA_ULTIMO)
+        g->ultimos++;
+}
+
+// Disparo: grava o anel com a numeração original das rajadas
+static void gatilho_descarregar(gatilho_estado_t *g)
+{
+    // A orientação recomeça pelo acelerômetro no primeiro registro do evento
+    for (int i = 0; i < SENSORES_MAX; i++)
+        sessao_orientacao[i] = sessao_captura - 1;
+
+    int numero = numero_amostra - (int)g->ultimos;
+    for (unsigned k = 0; k < g->qtd; k++)
+    {
+        const amostra_t *r = &pre_gatilho[(g->inicio + k) % g->pre_max];
+        if (gravar_registro(r, numero))
+            registros_omitidos--;
+        if (r->marcas & MARCA_ULTIMO)
+            numero++;
+    }
+    g->inicio = g->qtd = g->ultimos = 0;
+}
 
-        if (!sd_mount)
+// Formata um período do resumo: média, mínimo, máximo e RMS de cada eixo,
+// nas unidades do log
+static void gravar_periodo_resumo(uint8_t sensor, const resumo_saida_t *p)
+{
+    char linha[256];
+    int len = snprintf(linha, sizeof(linha), "%ld;%u", (long)p->numero, sensor);
+    float escalas[2];
+    sensores_escalas(sensor, &escalas[0], &escalas[1]);
+    for (int e = 0; e < RESUMO_EIXOS; e++)
+    {
+        if (config.formato == FORMATO_BRUTO)
+            len += snprintf(linha + len, sizeof(linha) - len, ";%d;%d;%d;%u", p->media[e], p->min[e], p->max[e],
+                            p->rms[e]);
+        else
         {
-            ssd1306_draw_string(&ssd, "Monte o SD", 5, 30);
+            float escala = escalas[e / 3];
+            len += snprintf(linha + len, sizeof(linha) - len, ";%.2f;%.2f;%.2f;%.2f", p->media[e] / escala,
+                            p->min[e] / escala, p->max[e] / escala, p->rms[e] / escala);
         }
-        else if (sd_mounting)
+    }
+    linha[len++] = '\n';
+    adicionar_linha_resumo(linha, len);
+}
+
+// Passa uma leitura ao resumo do seu sensor e grava os períodos prontos. O
+// resumo recomeça a cada captura, com fator leituras por período.
+static void CAMINHO_QUENTE(resumir)(const amostra_t *amostra)
+{
+    if (sessao_resumo != sessao_captura)
+    {
+        uint32_t fator = (taxa_captura + config.resumo_hz / 2) / config.resumo_hz;
+        if (fator == 0)
+            fator = 1;
+        for (int i = 0; i < SENSORES_MAX; i++)
+            resumo_iniciar(&resumos[i], fator);
+        sessao_resumo = sessao_captura;
+        resumo_pendente = true;
+        printf("[RESUMO] %.2f Hz (%lu leituras por linha) em %s\n", (float)taxa_captura / fator,
+               (unsigned long)fator, ARQUIVO_RESUMO);
+    }
+
+    resumo_saida_t periodo;
+    resumo_acumular(&resumos[amostra->sensor % SENSORES_MAX], &amostra->leitura, numero_amostra);
+    while (resumo_obter(&resumos[amostra->sensor % SENSORES_MAX], false, &periodo))
+        gravar_periodo_resumo(amostra->sensor, &periodo);
+}
+
+// Captura parada: os períodos que o FIR ainda não cobriu saem com a parte
+// acumulada, um sensor de cada vez para manter a ordem, e o staging do
+// resumo vai para o cartão
+static void encerrar_resumo(void)
+{
+    if (!resumo_pendente)
+        return;
+    resumo_pendente = false;
+
+    bool restam = true;
+    while (restam)
+    {
+        restam = false;
+        for (unsigned s = 0; s < sensores_qtd(); s++)
         {
-            if (sd_mount)
+            resumo_saida_t periodo;
+            uint8_t id = sensores_obter(s)->id;
+            if (resumo_obter(&resumos[id % SENSORES_MAX], true, &periodo))
             {
-                ssd1306_draw_string(&ssd, "Montando SD...", 5, 30);
+                gravar_periodo_resumo(id, &periodo);
+                restam = true;
             }
-            else
+        }
+    }
+    descarregar_resumo();
+}
+
+// Núcleo 1: formatação, compressão e E/S do cartão SD
+void CAMINHO_QUENTE(vGravacaoTask)(void *params)
+{
+    amostra_t amostra;
+    gatilho_estado_t gatilho = {0};
+    while (true)
+    {
+        // Pedido da montagem: com esta tarefa fora da fila, ela pode ser trocada
+        if (xEventGroupGetBits(xEventosEstado) & BIT_DIMENSIONAR)
+        {
+            dimensionar_fila();
+            xEventGroupClearBits(xEventosEstado, BIT_DIMENSIONAR);
+            xEventGroupSetBits(xEventosEstado, BIT_FILA_PRONTA);
+        }
+
+        if (xQueueReceive(xFilaAmostras, &amostra, pdMS_TO_TICKS(100)) == pdTRUE)
+        {
+            xEventGroupClearBits(xEventosEstado, BIT_GRAVACAO_OCIOSA);
+            uint32_t inicio = time_us_32();
+            bool ultimo = amostra.marcas & MARCA_ULTIMO;
+
+            // --- Resumo: todas as leituras, antes do gatilho ---
+            if (config.resumo_hz)
+                resumir(&amostra);
+
+            // --- Gatilho: fora de um evento o registro só vai para o anel ---
+            if (config.gatilho != GATILHO_CONTINUO)
             {
-                ssd1306_draw_string(&ssd, "Desmontando SD...", 5, 30);
+                if (gatilho.sessao != sessao_captura)
+                    gatilho_reiniciar(&gatilho);
+
+                if (gatilho_testar(amostra.sensor % SENSORES_MAX, &amostra.leitura,
+                                   amostra.marcas & MARCA_MOVIMENTO))
+                {
+                    if (!gatilho.em_evento)
+                    {
+                        printf("[GATILHO] Evento na amostra %d (sensor %u): %u registros antes do disparo\n",
+                               numero_amostra, amostra.sensor, gatilho.qtd);
+                        gatilho_descarregar(&gatilho);
+                        gatilho.em_evento = true;
+                    }
+                    gatilho.pos_restantes = gatilho.pos_rajadas + 1; // a rajada do disparo e as pos_ms seguintes
+                }
+                if (!gatilho.em_evento)
+                {
+                    gatilho_guardar(&gatilho, &amostra);
+                    if (ultimo)
+                        numero_amostra++;
+                    diag.tempo_gravacao_us += time_us_32() - inicio;
+                    continue;
+                }
+                if (ultimo && --gatilho.pos_restantes == 0)
+                    gatilho.em_evento = false; // este é o último registro do evento
             }
+
+            // Os registros de uma rajada compartilham o número da amostra
+            if (gravar_registro(&amostra, numero_amostra) && ultimo)
+                numero_amostra++;
+            diag.tempo_gravacao_us += time_us_32() - inicio;
         }
-        else if (ready && sensor_state)
+        else
         {
-            ssd1306_draw_string(&ssd, "Sistema", 5, 20);
-            ssd1306_draw_string(&ssd, "Ligado", 5, 30);
+            // Captura parada (ou cartão sendo desmontado): fecha o resumo e
+            // grava o bloco parcial antes de avisar que está ociosa
+            if (estado == ESTADO_PRONTO || estado == ESTADO_DESMONTANDO)
+            {
+                encerrar_resumo();
+                if (bloco_len > 0)
+                    descarregar_bloco();
+            }
+            xEventGroupSetBits(xEventosEstado, BIT_GRAVACAO_OCIOSA);
         }
-        else if (ready)
+    }
+}
+
+void vLedsTask(void *params)
+{
+    bool aceso = false; // fase do pisca-pisca (erro e gravação)
+
+    while (true)
+    {
+        EventBits_t bits = xEventGroupGetBits(xEventosEstado);
+        bool gravando = bits & BIT_GRAVANDO;
+        bool piscando = false;
+
+        bool verde = false, azul = false, vermelho = false;
+        switch (estado)
         {
-            ssd1306_draw_string(&ssd, "Sistema", 5, 20);
-            ssd1306_draw_string(&ssd, "Pronto", 5, 30);
+        case ESTADO_SEM_SD:
+        case ESTADO_PRONTO:
+            verde = true; // Liga o LED verde
+            break;
+        case ESTADO_CAPTURANDO:
+            vermelho = true; // Liga o LED vermelho
+            break;
+        case ESTADO_MONTANDO:
+        case ESTADO_DESMONTANDO:
+            vermelho = verde = true; // Amarelo
+            break;
+        case ESTADO_ERRO:
+            piscando = true;
+            azul = vermelho = aceso; // Roxo piscando
+            break;
         }
-        else if (capture)
+        if (gravando)
         {
-            ssd1306_draw_string(&ssd, "Sensor", 5, 20);
-            ssd1306_draw_string(&ssd, "Capturando...", 5, 30);
+            piscando = true;
+            azul = aceso; // Azul piscando durante a escrita no SD
         }
-        else if (error)
+
+        gpio_put(LED_PIN_GREEN, verde);
+        gpio_put(LED_PIN_BLUE, azul);
+        gpio_put(LED_PIN_RED, vermelho);
+
+        // Só acorda periodicamente enquanto algum LED pisca; caso contrário
+        // dorme até a próxima mudança de estado
+        TickType_t espera = piscando ? pdMS_TO_TICKS(200) : portMAX_DELAY;
+        xEventGroupWaitBits(xEventosEstado, BIT_UI_LEDS, pdTRUE, pdFALSE, espera);
+        aceso = piscando ? !aceso : false;
+    }
+}
+
+// Tela de status: mensagens do estado atual
+static void desenhar_status(ssd1306_t *ssd)
+{
+    ssd1306_fill(ssd, false); // Limpa a tela
+
+    switch (estado)
+    {
+    case ESTADO_SEM_SD:
+        ssd1306_draw_string(ssd, "Monte o SD", 5, 30);
+        break;
+    case ESTADO_MONTANDO:
+        ssd1306_draw_string(ssd, "Montando SD...", 5, 30);
+        break;
+    case ESTADO_DESMONTANDO:
+        ssd1306_draw_string(ssd, "Desmontando SD...", 5, 30);
+        break;
+    case ESTADO_PRONTO:
+        ssd1306_draw_string(ssd, "Sistema", 5, 20);
+        ssd1306_draw_string(ssd, "Pronto", 5, 30);
+        break;
+    case ESTADO_CAPTURANDO:
+        ssd1306_draw_string(ssd, "Sensor", 5, 20);
+        ssd1306_draw_string(ssd, "Capturando...", 5, 30);
+        break;
+    case ESTADO_ERRO:
+        ssd1306_draw_string(ssd, "Erro no SD Card", 5, 30);
+        break;
+    }
+    if (xEventGroupGetBits(xEventosEstado) & BIT_GRAVANDO)
+    {
+        ssd1306_draw_string(ssd, "Gravando SD...", 5, 45);
+    }
+}
+
+// Área do gráfico: páginas 1..7 (linhas 8..63); a página 0 é o título
+#define GRAFICO_P0 1
+#define GRAFICO_P1 7
+#define GRAFICO_Y0 (GRAFICO_P0 * 8)
+#define GRAFICO_ALTURA ((GRAFICO_P1 - GRAFICO_P0 + 1) * 8)
+
+static const char *nomes_canais[6] = {"Acel X", "Acel Y", "Acel Z", "Giro X", "Giro Y", "Giro Z"};
+
+// Converte a leitura bruta (fundo de escala int16) na linha do gráfico
+static uint8_t grafico_y(int16_t valor)
+{
+    int32_t y = GRAFICO_Y0 + GRAFICO_ALTURA / 2 - ((int32_t)valor * (GRAFICO_ALTURA / 2)) / 32768;
+    if (y < GRAFICO_Y0)
+        y = GRAFICO_Y0;
+    if (y > GRAFICO_Y0 + GRAFICO_ALTURA - 1)
+        y = GRAFICO_Y0 + GRAFICO_ALTURA - 1;
+    return y;
+}
+
+// Tela do gráfico: a cada ponto novo a área rola uma coluna e só a última
+// coluna é desenhada (segmento vertical entre o ponto anterior e o novo)
+static void desenhar_grafico(ssd1306_t *ssd, uint8_t canal, bool redesenhar, uint8_t *y_ant)
+{
+    if (redesenhar)
+    {
+        ssd1306_fill(ssd, false);
+        ssd1306_draw_string(ssd, nomes_canais[canal], 0, 0);
+        if (estado != ESTADO_CAPTURANDO)
+            ssd1306_draw_string(ssd, "Sem captura", 5, 30);
+        *y_ant = grafico_y(0);
+    }
+
+    amostra_t ponto;
+    while (xQueueReceive(xFilaGrafico, &ponto, 0) == pdTRUE)
+    {
+        int16_t valor = canal < 3 ? ponto.leitura.acel[canal] : ponto.leitura.giro[canal - 3];
+        uint8_t y = grafico_y(valor);
+        ssd1306_scroll_left(ssd, GRAFICO_P0, GRAFICO_P1);
+        ssd1306_vline(ssd, ssd->width - 1, y < *y_ant ? y : *y_ant, y < *y_ant ? *y_ant : y, true);
+        *y_ant = y;
+    }
+}
+
+// Tela de diagnóstico: taxas calculadas entre duas atualizações (1 s)
+static void desenhar_diagnostico(ssd1306_t *ssd, bool redesenhar)
+{
+    static uint32_t t_ant, lidas_ant, bytes_ant;
+    uint32_t agora = time_us_32();
+    uint32_t lidas = diag.amostras_lidas;
+    uint32_t bytes = diag.bytes_gravados;
+
+    if (redesenhar)
+    {
+        // Primeira atualização da tela: só guarda a referência das taxas
+        t_ant = agora;
+        lidas_ant = lidas;
+        bytes_ant = bytes;
+    }
+    uint32_t dt_ms = (agora - t_ant) / 1000;
+    uint32_t amostras_s = dt_ms ? (lidas - lidas_ant) * 1000 / dt_ms : 0;
+    uint32_t bytes_s = dt_ms ? (bytes - bytes_ant) * 1000 / dt_ms : 0;
+    t_ant = agora;
+    lidas_ant = lidas;
+    bytes_ant = bytes;
+
+    char linha[8][17];
+    snprintf(linha[0], sizeof(linha[0]), "Amost/s %lu", (unsigned long)amostras_s);
+    snprintf(linha[1], sizeof(linha[1]), "SD B/s %lu", (unsigned long)bytes_s);
+    // Durante a montagem a fila pode estar sendo trocada pela gravação
+    bool fila_valida = estado == ESTADO_PRONTO || estado == ESTADO_CAPTURANDO;
+    snprintf(linha[2], sizeof(linha[2]), "Fila %lu/%lu",
+             (unsigned long)(fila_valida ? uxQueueMessagesWaiting(xFilaAmostras) : 0), (unsigned long)fila_capacidade);
+    snprintf(linha[3], sizeof(linha[3]), "Fila max %lu", (unsigned long)diag.fila_max);
+    snprintf(linha[4], sizeof(linha[4]), "Perdidas %lu", (unsigned long)diag.amostras_perdidas);
+    snprintf(linha[5], sizeof(linha[5]), "Lat %lums", (unsigned long)(diag.lat_ultima_us / 1000));
+    snprintf(linha[6], sizeof(linha[6]), "Lat max %lums", (unsigned long)(diag.lat_max_us / 1000));
+    snprintf(linha[7], sizeof(linha[7]), "Heap %lu", (unsigned long)xPortGetFreeHeapSize());
+
+    ssd1306_fill(ssd, false);
+    for (int i = 0; i < 8; i++)
+        ssd1306_draw_string(ssd, linha[i], 0, i * 8);
+}
+
+// Tela de orientação: ângulos do primeiro sensor e um horizonte artificial
+// (linha inclinada pelo roll e deslocada pelo pitch)
+static void desenhar_orientacao(ssd1306_t *ssd)
+{
+    ssd1306_fill(ssd, false);
+    ssd1306_draw_string(ssd, "Orientacao", 0, 0);
+    if (!config.orientacao)
+    {
+        ssd1306_draw_string(ssd, "orientacao = 1", 0, 24);
+        ssd1306_draw_string(ssd, "no config.ini", 0, 34);
+        return;
+    }
+
+    static const char *nomes[3] = {"R", "P", "Y"};
+    float graus[3];
+    for (int i = 0; i < 3; i++)
+    {
+        char linha[17];
+        graus[i] = angulos_tela[i] / 100.0f;
+        snprintf(linha, sizeof(linha), "%s %7.1f", nomes[i], graus[i]);
+        ssd1306_draw_string(ssd, linha, 0, 16 + i * 12);
+    }
+
+    // Linha de meia largura raio/2 e deslocamento até raio/2: fica dentro da moldura
+    const float cx = 104, cy = 36, raio = 20;
+    float r = graus[0] * (float)M_PI / 180.0f;
+    float meio = raio / 2, dy = graus[1] / 90.0f * meio;
+    ssd1306_line(ssd, (uint8_t)(cx - meio * cosf(r)), (uint8_t)(cy + dy + meio * sinf(r)), (uint8_t)(cx + meio * cosf(r)),
+                 (uint8_t)(cy + dy - meio * sinf(r)), true);
+    ssd1306_rect(ssd, (uint8_t)(cy - raio - 2), (uint8_t)(cx - raio - 2), 2 * raio + 5, 2 * raio + 5, true, false);
+}
+
+// Fim do DMA do framebuffer (IRQ): acorda a tarefa do display
+static void display_dma_concluido(void *ctx)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)ctx, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+// Espera o envio (DMA) da página terminar. Um envio preso (barramento
+// travado) é interrompido, e o próximo quadro vai completo.
+static bool display_esperar_pagina(ssd1306_t *ssd)
+{
+    TickType_t inicio = xTaskGetTickCount();
+    while (ssd1306_busy(ssd))
+    {
+        if (xTaskGetTickCount() - inicio >= pdMS_TO_TICKS(DISPLAY_PAGINA_MAX_MS))
         {
-            ssd1306_draw_string(&ssd, "Erro no SD Card", 5, 30);
+            ssd1306_abort(ssd);
+            return false;
         }
-        else if (sd_writing)
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1));
+    }
+    return true;
+}
+
+void vDisplayTask(void *params)
+{
+    ssd1306_t ssd;
+    xSemaphoreTake(xMutexI2C1, portMAX_DELAY); // a captura pode estar procurando sensores no i2c1
+    init_Display(&ssd);
+    xSemaphoreGive(xMutexI2C1);
+    ssd1306_init_dma(&ssd, display_dma_concluido, xTaskGetCurrentTaskHandle());
+
+    tela_t tela = TELA_STATUS;
+    uint8_t canal = 0;
+    bool redesenhar = true;
+    uint8_t y_ant = 0;
+    estado_t estado_desenhado = estado; // estado no último redesenho completo
+
+    while (true)
+    {
+        if (redesenhar)
+            estado_desenhado = estado;
+        if (tela == TELA_GRAFICO)
+            desenhar_grafico(&ssd, canal, redesenhar, &y_ant);
+        else if (tela == TELA_DIAGNOSTICO)
+            desenhar_diagnostico(&ssd, redesenhar);
+        else if (tela == TELA_ORIENTACAO)
+            desenhar_orientacao(&ssd);
+        else
+            desenhar_status(&ssd);
+        redesenhar = false;
+
+        // O quadro vai uma página (até 128 B) por vez, com o i2c1 reservado
+        // só durante a página: uma rajada da captura espera no máximo uma
+        // página, mesmo em um redesenho completo. O envio (DMA) termina antes
+        // de o barramento ser devolvido.
+        for (uint8_t paginas = ssd1306_prepare(&ssd); paginas > 0; paginas--)
         {
-            ssd1306_draw_string(&ssd, "Gravando SD...", 5, 30);
+            xSemaphoreTake(xMutexI2C1, portMAX_DELAY);
+            bool enviada = ssd1306_send_page(&ssd) && display_esperar_pagina(&ssd);
+            xSemaphoreGive(xMutexI2C1);
+            if (!enviada)
+                break;
         }
-        else
+
+        // Dorme até o próximo comando do joystick, mudança de estado ou (na
+        // tela do gráfico) ponto novo. A tela de diagnóstico não acorda com
+        // mudanças de estado para manter a janela das taxas em 1 s.
+        EventBits_t espera = BIT_TELA | BIT_CANAL;
+        if (tela != TELA_DIAGNOSTICO)
+            espera |= BIT_UI_DISPLAY;
+        if (tela == TELA_GRAFICO)
+            espera |= BIT_GRAFICO;
+        // A tela de diagnóstico também é atualizada a cada segundo e a de orientação a cada 200 ms
+        TickType_t timeout = (tela == TELA_DIAGNOSTICO)   ? pdMS_TO_TICKS(1000)
+                             : (tela == TELA_ORIENTACAO) ? pdMS_TO_TICKS(200)
+                                                         : portMAX_DELAY;
+        EventBits_t bits = xEventGroupWaitBits(xEventosEstado, espera, pdTRUE, pdFALSE, timeout);
+
+        if (bits & BIT_TELA)
         {
-            ssd1306_draw_string(&ssd, "Estado desconhecido", 5, 30);
+            tela = (tela + 1) % TELA_QTD;
+            xQueueReset(xFilaGrafico); // descarta pontos acumulados fora da tela
         }
-        ssd1306_send_data(&ssd);        // Envia os dados para o display
-        vTaskDelay(pdMS_TO_TICKS(100)); // Delay para evitar flooding
+        if (bits & BIT_CANAL)
+            canal = (canal + 1) % 6;
+        if (bits & (BIT_TELA | BIT_CANAL))
+            redesenhar = true;
+        // No gráfico, o aviso de gravação de cada bloco não apaga a forma de
+        // onda: só uma mudança real de estado limpa a tela
+        else if ((bits & BIT_UI_DISPLAY) && (tela != TELA_GRAFICO || estado != estado_desenhado))
+            redesenhar = true;
     }
 }
 
+// Lê o joystick (ADC) e converte cada deflexão em um pedido para o display
+void vJoystickTask(void *params)
+{
+    adc_init();
+    adc_gpio_init(JOYSTICK_X_PIN);
+    adc_gpio_init(JOYSTICK_Y_PIN);
+
+    bool x_defletido = false, y_defletido = false;
+    while (true)
+    {
+        adc_select_input(0);
+        uint16_t x = adc_read();
+        adc_select_input(1);
+        uint16_t y = adc_read();
+
+        // Só a transição do centro para a borda gera um pedido
+        bool x_borda = x < 600 || x > 3500;
+        bool y_borda = y < 600 || y > 3500;
+        if (x_borda && !x_defletido)
+            xEventGroupSetBits(xEventosEstado, BIT_TELA);
+        if (y_borda && !y_defletido)
+            xEventGroupSetBits(xEventosEstado, BIT_CANAL);
+        x_defletido = x_borda;
+        y_defletido = y_borda;
+
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+}
+
+#if LOG_COMPRESS
+// Percorre os cabeçalhos dos blocos de dados.lzb, descomprime o último e copia
+// sua última linha completa. Usa o bloco de staging como área de trabalho.
+static bool ler_ultima_linha_lzb(FIL *file, char *ultima_linha, size_t cap)
+{
+    uint16_t raw_len, payload_len, crc;
+    uint8_t flags;
+    UINT br;
+    FSIZE_t pos = 0, ultimo = 0;
+    bool achou = false;
+
+    while (pos + LZB_HEADER_SIZE <= f_size(file))
+    {
+        f_lseek(file, pos);
+        if (f_read(file, bloco_lz, LZB_HEADER_SIZE, &br) != FR_OK || br != LZB_HEADER_SIZE ||
+            !lzb_parse_header(bloco_lz, &raw_len, &payload_len, &crc, &flags))
+            break;
+        ultimo = pos;
+        achou = true;
+        pos += LZB_HEADER_SIZE + payload_len;
+    }
+    if (!achou)
+        return false;
+
+    f_lseek(file, ultimo);
+    if (f_read(file, bloco_lz, sizeof(bloco_lz), &br) != FR_OK)
+        return false;
+    int n = lzb_decode_block(bloco_lz, br, (uint8_t *)bloco, sizeof(bloco));
+    if (n <= 1)
+        return false;
+
+    // Volta até a quebra de linha anterior à última
+    int inicio = n - 1;
+    while (inicio > 0 && bloco[inicio - 1] != '\n')
+        inicio--;
+    size_t len = n - inicio;
+    if (len >= cap)
+        len = cap - 1;
+    memcpy(ultima_linha, &bloco[inicio], len);
+    ultima_linha[len] = '\0';
+    return true;
+}
+#endif
+
 int criar_cabecalho_csv()
 {
     FIL file;
@@ -274,10 +1476,16 @@ int criar_cabecalho_csv()
     fr = f_open(&file, nome_arquivo, FA_WRITE | FA_CREATE_NEW);
     if (fr == FR_OK)
     {
-        const char *cabecalho = "numero_amostra;accel_x;accel_y;accel_z;giro_x;giro_y;giro_z\n";
+        const char *cabecalho = config.orientacao ? cabecalho_orientacao : cabecalho_csv;
+#if LOG_COMPRESS
+        // O cabeçalho vai no início do primeiro bloco comprimido
+        f_close(&file);
+        adicionar_linha(cabecalho, strlen(cabecalho));
+#else
         UINT bw;
         f_write(&file, cabecalho, strlen(cabecalho), &bw);
         f_close(&file);
+#endif
         printf("[INFO] Arquivo criado com cabeçalho.\n");
         return 1; // começa do zero
     }
@@ -293,6 +1501,11 @@ int criar_cabecalho_csv()
             return numero_amostra;
         }
 
+        char ultima_linha[128] = {0};
+#if LOG_COMPRESS
+        ler_ultima_linha_lzb(&file, ultima_linha, sizeof(ultima_linha));
+        f_close(&file);
+#else
         // Move o ponteiro para o fim do arquivo
         f_lseek(&file, f_size(&file));
 
@@ -313,10 +1526,10 @@ int criar_cabecalho_csv()
         }
 
         // Agora lê a última linha
-        char ultima_linha[128] = {0};
         UINT br;
         f_read(&file, ultima_linha, sizeof(ultima_linha) - 1, &br);
         f_close(&file);
+#endif
 
         // A linha deve estar no formato: numero_amostra;...
         int ultimo_numero = 0;
@@ -332,69 +1545,621 @@ int criar_cabecalho_csv()
     }
 }
 
+// Cria o ARQUIVO_RESUMO com o cabeçalho se ele não existir
+static void criar_cabecalho_resumo(void)
+{
+    FIL file;
+    if (f_open(&file, ARQUIVO_RESUMO, FA_WRITE | FA_CREATE_NEW) != FR_OK)
+        return; // já existe: as linhas novas continuam o arquivo
+    f_printf(&file, "numero_amostra;sensor");
+    for (int e = 0; e < RESUMO_EIXOS; e++)
+        f_printf(&file, ";%s_media;%s_min;%s_max;%s_rms", eixos_resumo[e], eixos_resumo[e], eixos_resumo[e],
+                 eixos_resumo[e]);
+    f_printf(&file, "\n");
+    f_close(&file);
+    printf("[INFO] Arquivo %s criado com cabeçalho.\n", ARQUIVO_RESUMO);
+}
+
 void vMontagemTask(void *params)
 {
     while (true)
     {
-        if (xSemaphoreTake(xSemBotaoB, portMAX_DELAY) == pdTRUE)
+        if (xSemaphoreTake(xSemMontagem, portMAX_DELAY) == pdTRUE)
         {
             const char *drive = sd_get_by_num(0)->pcName;
             FATFS *p_fs = &sd_get_by_num(0)->fatfs;
             sd_card_t *pSD = sd_get_by_name(drive);
 
-            sensor_state = false; // Desliga o sensor durante a montagem/desmontagem
-            ready = false;        // Indica que o sistema não está pronto para capturar dados
-            capture = false;      // Desativa a captura de dados
-            sd_mounting = true;   // Indica que o sistema está montando/desmontando o SD
-
-            if (!sd_mount)
+            if (estado == ESTADO_MONTANDO)
             {
                 FRESULT fr = f_mount(p_fs, drive, 1);
                 if (fr == FR_OK)
                 {
-                    error = false;
                     pSD->mounted = true;
-                    sd_mount = true;
-
+                    sd_latencia_zerar(&pSD->lat_escrita);
                     printf("[MONTAGEM] Cartão SD montado com sucesso.\n");
 
-                    vTaskDelay(pdMS_TO_TICKS(500));         // Delay para evitar flooding
-                    sd_mounting = false;                    // Indica que o sistema terminou de montar/desmontar o SD
-                    ready = true;                           // Indica que o sistema está pronto para capturar dados
+                    config_padrao(&config);
+                    config_carregar(&config); // Lê (ou cria) o config.ini
+                    calibracao_carregar();    // Lê o calib.ini, se existir
+                    printf("[CONFIG] %u Hz, DLPF %u, formato %s%s\n", config.taxa_hz, config.dlpf,
+                           config.formato == FORMATO_BRUTO ? "bruto" : "csv", config.orientacao ? ", orientacao" : "");
+                    if (config.resumo_hz)
+                        printf("[CONFIG] Resumo a %u Hz em %s\n", config.resumo_hz, ARQUIVO_RESUMO);
+                    if (config.gatilho != GATILHO_CONTINUO)
+                        printf("[CONFIG] Gatilho %s (%u mg, %u dps), janela de %u ms antes e %u ms depois\n",
+                               config_nome_gatilho(config.gatilho), config.limiar_mg, config.limiar_dps, config.pre_ms,
+                               config.pos_ms);
+
+                    // Mede o cartão e ajusta a fila à taxa configurada (feito pela gravação)
+                    redimensionar_fila();
+
                     numero_amostra = criar_cabecalho_csv(); // Cria o cabeçalho do CSV se não existir
+                    if (config.resumo_hz)
+                        criar_cabecalho_resumo();
+                    enviar_evento(EVENTO_MONTADO);
                 }
                 else
                 {
                     printf("[ERRO] Falha ao montar o cartão: %s (%d)\n", FRESULT_str(fr), fr);
-                    error = true;
                     pSD->mounted = false;
-                    sd_mount = false;
+                    enviar_evento(EVENTO_FALHA_SD);
                 }
             }
-            else
+            else if (estado == ESTADO_DESMONTANDO)
             {
+                // Espera a captura parar e a gravação consumir as amostras em trânsito
+                esperar_gravacao_ociosa();
+                descarregar_bloco(); // Grava o que restou no bloco antes de desmontar
+                descarregar_resumo();
+
                 FRESULT fr = f_unmount(drive);
                 if (fr == FR_OK)
                 {
-                    error = false;
                     pSD->mounted = false;
                     pSD->m_Status |= STA_NOINIT;
-                    sd_mount = false;
                     printf("[DESMONTAGEM] Cartão SD desmontado com sucesso.\n");
-
-                    vTaskDelay(pdMS_TO_TICKS(500)); // Delay para evitar flooding
-
-                    sd_mounting = false; // Indica que o sistema terminou de montar/desmontar o SD
-                    ready = true;        // Indica que o sistema está pronto para capturar dados
+                    enviar_evento(EVENTO_DESMONTADO);
                 }
                 else
                 {
-                    error = true;
                     printf("[ERRO] Falha ao desmontar o cartão: %s (%d)\n", FRESULT_str(fr), fr);
+                    enviar_evento(EVENTO_FALHA_SD);
                 }
             }
         }
-        vTaskDelay(pdMS_TO_TICKS(100)); // Delay para evitar flooding
+    }
+}
+
+// Comandos do console USB: digite o nome e Enter no terminal serial
+typedef struct
+{
+    const char *nome;
+    const char *ajuda;
+    void (*executar)(const char *args);
+} comando_t;
+
+static void cmd_ajuda(const char *args);
+static void cmd_bench(const char *args);
+static void cmd_estresse(const char *args);
+static void cmd_jitter(const char *args);
+static void cmd_tarefas(const char *args);
+static void cmd_trace(const char *args);
+static void cmd_latencia(const char *args);
+static void cmd_sensores(const char *args);
+static void cmd_calibrar(const char *args);
+static void cmd_orientacao(const char *args);
+
+static const comando_t comandos[] = {
+    {"ajuda", "lista os comandos", cmd_ajuda},
+    {"bench", "benchmark do cartao SD (estado pronto)", cmd_bench},
+    {"estresse", "taxas de 100 Hz a 2 kHz; 'estresse sint' sem o sensor", cmd_estresse},
+    {"jitter", "jitter do periodo e das leituras na taxa do config.ini", cmd_jitter},
+    {"tarefas", "CPU e pilha livre de cada tarefa desde o ultimo comando", cmd_tarefas},
+    {"trace", "despeja o trace; 'trace sd' grava trace.bin, 'trace limpar'", cmd_trace},
+    {"latencia", "histograma das escritas no SD; 'latencia zerar'", cmd_latencia},
+    {"sensores", "sensores encontrados, driver, endereco e escalas", cmd_sensores},
+    {"calibrar", "'calibrar giro' parado, 'calibrar acel +x'..'-z', 'calibrar zerar'", cmd_calibrar},
+    {"orientacao", "custo do filtro de orientacao (us e ciclos por atualizacao)", cmd_orientacao},
+};
+
+static void cmd_ajuda(const char *args)
+{
+    for (size_t i = 0; i < count_of(comandos); i++)
+        printf("  %-8s %s\n", comandos[i].nome, comandos[i].ajuda);
+}
+
+static void cmd_bench(const char *args)
+{
+    if (estado != ESTADO_PRONTO)
+    {
+        printf("[BENCH] Monte o cartão e pare a captura antes do benchmark\n");
+        return;
+    }
+    // O mutex do bloco serializa o acesso ao FatFs com a gravação
+    xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+    bench_sd_executar(sd_get_by_num(0));
+    xSemaphoreGive(xMutexBloco);
+}
+
+// Marca dos contadores de run-time stats para medir o tempo de CPU de cada
+// tarefa em uma janela
+typedef struct
+{
+    configRUN_TIME_COUNTER_TYPE total;
+    configRUN_TIME_COUNTER_TYPE tarefas[TAREFAS_MAX]; // por xTaskNumber
+} cpu_marca_t;
+
+// Estado das tarefas com ulRunTimeCounter trocado pelo tempo de CPU desde a
+// marca, que passa a ser o instante atual. *janela recebe a capacidade dos
+// dois núcleos na janela. O vetor vem do heap (vPortFree); NULL sem memória.
+static TaskStatus_t *cpu_janela(cpu_marca_t *marca, UBaseType_t *n, configRUN_TIME_COUNTER_TYPE *janela)
+{
+    *n = uxTaskGetNumberOfTasks();
+    TaskStatus_t *tarefas = pvPortMalloc(*n * sizeof(TaskStatus_t));
+    if (tarefas == NULL)
+        return NULL;
+
+    configRUN_TIME_COUNTER_TYPE total;
+    *n = uxTaskGetSystemState(tarefas, *n, &total);
+    *janela = (total - marca->total) * configNUMBER_OF_CORES;
+    marca->total = total;
+    for (UBaseType_t i = 0; i < *n; i++)
+    {
+        TaskStatus_t *t = &tarefas[i];
+        if (t->xTaskNumber < TAREFAS_MAX)
+        {
+            configRUN_TIME_COUNTER_TYPE atual = t->ulRunTimeCounter;
+            t->ulRunTimeCounter -= marca->tarefas[t->xTaskNumber];
+            marca->tarefas[t->xTaskNumber] = atual;
+        }
+    }
+    return tarefas;
+}
+
+// Tempo de CPU de cada tarefa (run-time stats do FreeRTOS, contados em µs
+// pelo timer do RP2040) na janela desde a chamada anterior, e a menor folga
+// de pilha já observada. As porcentagens são da capacidade dos dois
+// núcleos: somadas às das tarefas Idle dão 100%.
+static void cmd_tarefas(const char *args)
+{
+    static const char letras_estado[] = {'X', 'R', 'B', 'S', 'D', '?'};
+    static cpu_marca_t marca;
+
+    UBaseType_t n;
+    configRUN_TIME_COUNTER_TYPE janela;
+    TaskStatus_t *tarefas = cpu_janela(&marca, &n, &janela);
+    if (tarefas == NULL)
+    {
+        printf("[TAREFAS] Sem memória para %u tarefas\n", (unsigned)n);
+        return;
+    }
+
+    printf("[TAREFAS] janela de %lu ms, %d nucleo(s)\n", (unsigned long)((janela / configNUMBER_OF_CORES) / 1000),
+           configNUMBER_OF_CORES);
+    printf("[TAREFAS] %-16s est prio nucleos   cpu%%   cpu_us pilha_livre\n", "nome");
+    for (UBaseType_t i = 0; i < n; i++)
+    {
+        TaskStatus_t *t = &tarefas[i];
+        configRUN_TIME_COUNTER_TYPE usado = t->ulRunTimeCounter;
+        unsigned estado_tarefa = t->eCurrentState < sizeof(letras_estado) ? t->eCurrentState : sizeof(letras_estado) - 1;
+#if configUSE_CORE_AFFINITY
+        unsigned nucleos = (unsigned)(t->uxCoreAffinityMask & ((1u << configNUMBER_OF_CORES) - 1));
+#else
+        unsigned nucleos = 1;
+#endif
+        printf("[TAREFAS] %-16s  %c  %4u    0x%02x %6.2f %8lu %6lu B\n", t->pcTaskName, letras_estado[estado_tarefa],
+               (unsigned)t->uxCurrentPriority, nucleos, janela ? 100.0f * usado / janela : 0.0f, (unsigned long)usado,
+               (unsigned long)(t->usStackHighWaterMark * sizeof(StackType_t)));
+    }
+    printf("[TAREFAS] heap livre %u B (minimo %u B)\n", (unsigned)xPortGetFreeHeapSize(),
+           (unsigned)xPortGetMinimumEverFreeHeapSize());
+    vPortFree(tarefas);
+}
+
+// Trace dos caminhos críticos (lib/trace.h, build com TRACE=1)
+static void cmd_trace(const char *args)
+{
+#if TRACE
+    if (strcmp(args, "limpar") == 0)
+    {
+        trace_limpar();
+    }
+    else if (strcmp(args, "sd") == 0)
+    {
+        if (estado != ESTADO_PRONTO && estado != ESTADO_CAPTURANDO)
+        {
+            printf("[TRACE] Cartão não montado\n");
+            return;
+        }
+        xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+        int fr = trace_gravar_arquivo("trace.bin");
+        xSemaphoreGive(xMutexBloco);
+        printf("[TRACE] trace.bin: %s\n", fr == FR_OK ? "gravado" : FRESULT_str(fr));
+    }
+    else
+    {
+        trace_despejar_usb();
+    }
+#else
+    printf("[TRACE] Firmware compilado sem TRACE (cmake -DTRACE=ON)\n");
+#endif
+}
+
+// Latência das escritas do cartão desde a montagem (ou o último 'zerar'),
+// comparada com o tempo que a fila de amostras cobre na taxa configurada
+static void cmd_latencia(const char *args)
+{
+    sd_latencia_t *lat = &sd_get_by_num(0)->lat_escrita;
+    if (strcmp(args, "zerar") == 0)
+    {
+        sd_latencia_zerar(lat);
+        return;
+    }
+
+    sd_latencia_t copia = *lat; // a gravação continua atualizando o original
+    if (copia.comandos == 0)
+    {
+        printf("[LATENCIA] Nenhuma escrita registrada\n");
+        return;
+    }
+    printf("[LATENCIA] %lu escritas, %lu setores, media %lu us\n", (unsigned long)copia.comandos,
+           (unsigned long)copia.setores, (unsigned long)(copia.soma_us / copia.comandos));
+    printf("[LATENCIA] p50 %lu us, p90 %lu us, p99 %lu us, p99.9 %lu us, max %lu us\n",
+           (unsigned long)sd_latencia_percentil(&copia, 500), (unsigned long)sd_latencia_percentil(&copia, 900),
+           (unsigned long)sd_latencia_percentil(&copia, 990), (unsigned long)sd_latencia_percentil(&copia, 999),
+           (unsigned long)copia.lat_max_us);
+    printf("[LATENCIA] us");
+    sd_latencia_imprimir_hist(&copia);
+
+    // Sem captura ainda, avalia pela taxa do config.ini
+    uint16_t taxa = taxa_captura ? taxa_captura : config.taxa_hz;
+    if (taxa == 0)
+        return;
+    uint32_t folga = folga_fila_us(taxa);
+    uint32_t p99 = sd_latencia_percentil(&copia, 990);
+    printf("[LATENCIA] folga da fila a %u Hz: %lu us -> %s\n", taxa, (unsigned long)folga,
+           copia.comandos < LAT_MIN_COMANDOS ? "poucas escritas para avaliar"
+           : p99 > folga                    ? "CARTAO LENTO para esta taxa"
+                                            : "cartao adequado");
+}
+
+static void cmd_sensores(const char *args)
+{
+    sensores_imprimir();
+}
+
+// Espera a captura parar e a gravação esvaziar a fila, e grava o bloco parcial
+static void aguardar_gravacao(void)
+{
+    esperar_gravacao_ociosa();
+    descarregar_bloco();
+}
+
+// Log do usuário guardado enquanto um benchmark usa a captura
+typedef struct
+{
+    config_t config;
+    int numero;
+    const char *arquivo;
+} log_salvo_t;
+
+// Grava o que sobrou do log e passa a gravar em ARQUIVO_ESTRESSE, apagado antes
+static void log_desviar(log_salvo_t *salvo)
+{
+    salvo->config = config;
+    salvo->numero = numero_amostra;
+    salvo->arquivo = nome_arquivo;
+    config.gatilho = GATILHO_CONTINUO; // o benchmark grava todos os registros
+    config.resumo_hz = 0;
+
+    descarregar_bloco(); // o que sobrou do log vai para o arquivo do log
+    xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+    nome_arquivo = ARQUIVO_ESTRESSE;
+    f_unlink(nome_arquivo);
+    xSemaphoreGive(xMutexBloco);
+}
+
+// Volta ao log do usuário com a configuração, o arquivo e a numeração de
+// antes, e com a fila dimensionada de novo para a taxa do config.ini
+static void log_restaurar(const log_salvo_t *salvo)
+{
+    sensores_fonte_sintetica(false);
+    config = salvo->config;
+    xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+    nome_arquivo = salvo->arquivo;
+    numero_amostra = salvo->numero;
+    xSemaphoreGive(xMutexBloco);
+    redimensionar_fila();
+}
+
+// Benchmark de estresse: roda o pipeline inteiro (leitura, conversão,
+// formatação/compressão e gravação) em taxas crescentes e mostra a maior
+// taxa sem perdas. Antes de cada taxa a fila é dimensionada para ela, como
+// na montagem, para que o resultado não dependa do config.ini. Os dados vão
+// para ARQUIVO_ESTRESSE, fora do log. Com a
+// fonte sintética o I2C sai da conta: se ela sustenta uma taxa que o sensor
+// real não sustenta, o limite é o barramento, não o armazenamento.
+void estresse_executar(bool sintetica)
+{
+    static const uint16_t taxas[] = {100, 500, 1000, 2000};
+
+    if (estado != ESTADO_PRONTO)
+    {
+        printf("[ESTRESSE] Monte o cartão e pare a captura antes do benchmark\n");
+        return;
+    }
+
+    log_salvo_t salvo;
+    log_desviar(&salvo);
+
+    sensores_fonte_sintetica(sintetica);
+    config.dlpf = 0; // base de 8 kHz: o sensor não limita as taxas testadas
+
+    unsigned n = registros_por_rajada();
+    printf("[ESTRESSE] Fonte %s, %u sensor(es), formato %s, %d s por taxa, fila dimensionada por taxa\n",
+           sintetica ? "sintetica" : "MPU6050", n, config.formato == FORMATO_BRUTO ? "bruto" : "csv",
+           ESTRESSE_SEGUNDOS);
+    printf("[ESTRESSE]  alvo   real  lidas atrasos perdidas fila_max/cap capt%% grav%%  KB/s periodo\n");
+
+    static cpu_marca_t marca; // fora da pilha do console
+    uint16_t sustentada = 0;
+    for (size_t i = 0; i < count_of(taxas); i++)
+    {
+        config.taxa_hz = taxas[i];
+        redimensionar_fila();
+        diagnostico_t antes = diag;
+        diag.fila_max = 0;
+        UBaseType_t n_tarefas;
+        configRUN_TIME_COUNTER_TYPE janela;
+        vPortFree(cpu_janela(&marca, &n_tarefas, &janela)); // só marca o início
+
+        uint32_t t0 = time_us_32();
+        enviar_evento(EVENTO_BOTAO_A); // liga a captura
+        vTaskDelay(pdMS_TO_TICKS(ESTRESSE_SEGUNDOS * 1000));
+        enviar_evento(EVENTO_BOTAO_A); // desliga
+        aguardar_gravacao();
+        uint32_t duracao_us = time_us_32() - t0;
+
+        uint32_t lidas = diag.amostras_lidas - antes.amostras_lidas;
+        uint32_t atrasos = diag.periodos_atrasados - antes.periodos_atrasados;
+        uint32_t perdidas = diag.amostras_perdidas - antes.amostras_perdidas;
+        uint32_t gravadas = diag.registros_gravados - antes.registros_gravados;
+        uint32_t bytes = diag.bytes_gravados - antes.bytes_gravados;
+        float captura = 100.0f * (diag.tempo_captura_us - antes.tempo_captura_us) / duracao_us;
+        float gravacao = 100.0f * (diag.tempo_gravacao_us - antes.tempo_gravacao_us) / duracao_us;
+
+        // Período: o tick, o alarme de hardware ou lotes de rajadas por tick
+        const char *ritmo = taxa_captura <= configTICK_RATE_HZ ? "tick" : captura_em_lotes ? "lotes" : "alarme";
+        printf("[ESTRESSE] %5u %6lu %6lu %7lu %8lu %7lu/%-4lu %5.1f %5.1f %5lu %s\n", taxas[i],
+               (unsigned long)(lidas / n / ESTRESSE_SEGUNDOS), (unsigned long)lidas, (unsigned long)atrasos,
+               (unsigned long)perdidas, (unsigned long)diag.fila_max, (unsigned long)fila_capacidade, captura, gravacao,
+               (unsigned long)(bytes / 1024 * 1000000ull / duracao_us), ritmo);
+
+        // CPU de cada tarefa na janela da taxa (como no comando tarefas)
+        TaskStatus_t *tarefas = cpu_janela(&marca, &n_tarefas, &janela);
+        if (tarefas != NULL && janela > 0)
+        {
+            printf("[ESTRESSE]   cpu%%");
+            for (UBaseType_t k = 0; k < n_tarefas; k++)
+                if (tarefas[k].ulRunTimeCounter * 1000 >= janela) // a partir de 0,1%
+                    printf(" %s %.1f", tarefas[k].pcTaskName, 100.0f * tarefas[k].ulRunTimeCounter / janela);
+            printf("\n");
+        }
+        vPortFree(tarefas);
+
+        // Sustentada: sem descartes, tudo gravado e pelo menos 98% da taxa alvo em cada sensor
+        if (atrasos == 0 && perdidas == 0 && gravadas == lidas &&
+            lidas * 100 >= (uint32_t)taxas[i] * n * ESTRESSE_SEGUNDOS * 98)
+            sustentada = taxas[i];
+    }
+
+    if (sustentada)
+        printf("[ESTRESSE] Maior taxa sem perdas: %u Hz\n", sustentada);
+    else
+        printf("[ESTRESSE] Nenhuma taxa sem perdas\n");
+
+    log_restaurar(&salvo);
+}
+
+static void cmd_estresse(const char *args)
+{
+    estresse_executar(strcmp(args, "sint") == 0);
+}
+
+static void imprimir_jitter(const char *nome, const sd_latencia_t *hist)
+{
+    printf("[JITTER] %s: p50 %lu us, p99 %lu us, p99.9 %lu us, max %lu us\n", nome,
+           (unsigned long)sd_latencia_percentil(hist, 500), (unsigned long)sd_latencia_percentil(hist, 990),
+           (unsigned long)sd_latencia_percentil(hist, 999), (unsigned long)hist->lat_max_us);
+    printf("[JITTER]   us");
+    sd_latencia_imprimir_hist(hist);
+}
+
+// Benchmark de jitter: captura com o sensor na taxa do config.ini por
+// JITTER_SEGUNDOS, gravando em ARQUIVO_ESTRESSE como no log, e mostra o
+// desvio de cada período em relação ao ideal e a duração de cada rajada.
+// O resultado só vale para o build em uso: compare um build com
+// CAPTURA_RAM=ON e outro sem; as falhas do cache XIP aparecem na cauda.
+void jitter_executar(void)
+{
+    if (estado != ESTADO_PRONTO)
+    {
+        printf("[JITTER] Monte o cartão e pare a captura antes do benchmark\n");
+        return;
+    }
+
+    log_salvo_t salvo;
+    log_desviar(&salvo);
+    redimensionar_fila(); // não herda a fila de um benchmark anterior
+    sd_latencia_zerar(&jitter_periodo);
+    sd_latencia_zerar(&jitter_leitura);
+    diagnostico_t antes = diag;
+
+    printf("[JITTER] Caminho quente na %s (CAPTURA_RAM=%d), %u Hz por %d s\n", CAPTURA_RAM ? "SRAM" : "flash",
+           CAPTURA_RAM, config.taxa_hz, JITTER_SEGUNDOS);
+    medindo_jitter = true;
+    enviar_evento(EVENTO_BOTAO_A); // liga a captura
+    vTaskDelay(pdMS_TO_TICKS(JITTER_SEGUNDOS * 1000));
+    enviar_evento(EVENTO_BOTAO_A); // desliga
+    aguardar_gravacao();
+    medindo_jitter = false;
+
+    imprimir_jitter("periodo", &jitter_periodo);
+    imprimir_jitter("rajada", &jitter_leitura);
+    printf("[JITTER] %lu leituras de %u sensor(es) a %u Hz%s, %lu periodos atrasados, %lu perdidas\n",
+           (unsigned long)(diag.amostras_lidas - antes.amostras_lidas), sensores_qtd(), taxa_captura,
+           captura_em_lotes ? " (em lotes por tick)" : "",
+           (unsigned long)(diag.periodos_atrasados - antes.periodos_atrasados),
+           (unsigned long)(diag.amostras_perdidas - antes.amostras_perdidas));
+
+    log_restaurar(&salvo);
+}
+
+static void cmd_jitter(const char *args)
+{
+    jitter_executar();
+}
+
+// Calibração (lib/calibracao.h): coleta CALIB_SEGUNDOS de leituras brutas
+// de todos os sensores a CALIB_TAXA_HZ pela captura, gravando em
+// ARQUIVO_ESTRESSE, e calcula o bias do giroscópio ou a média da posição
+// do acelerômetro. O resultado vai para o calib.ini e vale a partir da
+// próxima captura. Sem argumentos, mostra a calibração atual.
+void calibrar_executar(const char *args)
+{
+    if (*args == '\0')
+    {
+        calibracao_imprimir();
+        return;
+    }
+
+    bool giro = strcmp(args, "giro") == 0;
+    int posicao = strncmp(args, "acel ", 5) == 0 ? calibracao_posicao(args + 5) : -1;
+    bool zerar = strcmp(args, "zerar") == 0;
+    if (!giro && posicao < 0 && !zerar)
+    {
+        printf("[CALIB] Use: calibrar giro | calibrar acel +x|-x|+y|-y|+z|-z | calibrar zerar\n");
+        return;
+    }
+    if (estado != ESTADO_PRONTO)
+    {
+        printf("[CALIB] Monte o cartão e pare a captura antes de calibrar\n");
+        return;
+    }
+
+    if (zerar)
+    {
+        calibracao_zerar();
+        xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+        f_unlink(CALIB_ARQUIVO);
+        xSemaphoreGive(xMutexBloco);
+        printf("[CALIB] Calibração descartada\n");
+        return;
+    }
+    if (sensores_qtd() == 0)
+    {
+        printf("[CALIB] Nenhum sensor para calibrar\n");
+        return;
+    }
+
+    log_salvo_t salvo;
+    log_desviar(&salvo);
+    config.taxa_hz = CALIB_TAXA_HZ;
+    redimensionar_fila();
+
+    printf("[CALIB] Coletando %d s %s, mantenha os sensores parados...\n", CALIB_SEGUNDOS,
+           giro ? "do giroscopio" : "do acelerometro");
+    calibracao_coleta_iniciar();
+    enviar_evento(EVENTO_BOTAO_A); // liga a captura
+    vTaskDelay(pdMS_TO_TICKS(CALIB_SEGUNDOS * 1000));
+    enviar_evento(EVENTO_BOTAO_A); // desliga
+    aguardar_gravacao();
+    calibracao_coleta_parar();
+
+    bool mudou = false;
+    for (unsigned s = 0; s < sensores_qtd(); s++)
+    {
+        const sensor_t *sensor = sensores_obter(s);
+        if (giro ? calibracao_giro(sensor) : calibracao_acel(sensor, posicao))
+            mudou = true;
+    }
+    log_restaurar(&salvo);
+
+    if (mudou)
+    {
+        xSemaphoreTake(xMutexBloco, portMAX_DELAY);
+        bool ok = calibracao_salvar();
+        xSemaphoreGive(xMutexBloco);
+        if (ok)
+            printf("[CALIB] %s gravado\n", CALIB_ARQUIVO);
+    }
+}
+
+static void cmd_calibrar(const char *args)
+{
+    calibrar_executar(args);
+}
+
+// Benchmark do filtro de orientação (lib/orientacao.h), fora do pipeline.
+// A tarefa do console pode ser interrompida: vale a melhor das rodadas.
+static void cmd_orientacao(const char *args)
+{
+    orientacao_bench(10000);
+}
+
+// Lê linhas do stdio USB e executa o comando correspondente
+// Chegou dado no stdio (IRQ do USB): acorda o console
+static void console_dados(void *ctx)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)ctx, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void vConsoleTask(void *params)
+{
+    char linha[CONSOLE_LINHA_TAM];
+    size_t len = 0;
+
+    stdio_set_chars_available_callback(console_dados, xTaskGetCurrentTaskHandle());
+    while (true)
+    {
+        // Esvazia o que chegou e dorme até o próximo aviso do stdio (um
+        // aviso entre o último getchar e a espera fica pendente na notificação)
+        int c = getchar_timeout_us(0);
+        if (c == PICO_ERROR_TIMEOUT)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        if (c != '\r' && c != '\n')
+        {
+            if (len < sizeof(linha) - 1)
+                linha[len++] = (char)c;
+            continue;
+        }
+        if (len == 0)
+            continue;
+        linha[len] = '\0';
+        len = 0;
+
+        // Nome do comando e argumentos separados pelo primeiro espaço
+        const char *args = "";
+        char *espaco = strchr(linha, ' ');
+        if (espaco != NULL)
+        {
+            *espaco = '\0';
+            args = espaco + 1;
+        }
+
+        size_t i = 0;
+        while (i < count_of(comandos) && strcmp(linha, comandos[i].nome) != 0)
+            i++;
+        if (i < count_of(comandos))
+            comandos[i].executar(args);
+        else
+            printf("Comando desconhecido: %s (digite ajuda)\n", linha);
     }
 }
 
@@ -430,13 +2195,48 @@ int main()
     gpio_set_irq_enabled_with_callback(BOTAO_B, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
     gpio_set_irq_enabled_with_callback(JOYSTICK_BTN_PIN, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
 
+    config_padrao(&config);
+
     // Criação dos semáforos
-    xSemBotaoB = xSemaphoreCreateBinary();
+    xSemMontagem = xSemaphoreCreateBinaryStatic(&sem_montagem_mem);
+    xMutexBloco = xSemaphoreCreateMutexStatic(&mutex_bloco_mem);
+    xMutexI2C1 = xSemaphoreCreateMutexStatic(&mutex_i2c1_mem);
+    xFilaEventos = xQueueCreateStatic(FILA_EVENTOS_TAM, sizeof(evento_t), fila_eventos_area, &fila_eventos_mem);
+    xEventosEstado = xEventGroupCreateStatic(&eventos_estado_mem);
+    xEventGroupSetBits(xEventosEstado, BIT_CAPTURA_PARADA);
+
+    xFilaAmostras = criar_fila_amostras(FILA_AMOSTRAS_TAM);
+    xFilaGrafico = xQueueCreateStatic(FILA_GRAFICO_TAM, sizeof(amostra_t), fila_grafico_area, &fila_grafico_mem);
+
+    // Todas as tarefas usam pilha e TCB da arena (lib/arena.h)
+    __attribute__((unused)) // só usados para a afinidade (não há no simulador)
+    TaskHandle_t xEstado, xCaptura, xLeds, xMontagem, xDisplay, xGravacao, xJoystick, xConsole;
+    xEstado = xTaskCreateStatic(vEstadoTask, "Estado Task", count_of(pilha_estado), NULL, 3, pilha_estado, &tcb_estado);
+    xCaptura = xTaskCreateStatic(vCapturaTask, "Captura Task", count_of(pilha_captura), NULL, 2, pilha_captura,
+                                 &tcb_captura);
+    xLeds = xTaskCreateStatic(vLedsTask, "Leds Task", count_of(pilha_leds), NULL, 1, pilha_leds, &tcb_leds);
+    xMontagem = xTaskCreateStatic(vMontagemTask, "Montagem Task", count_of(pilha_montagem), NULL, 1, pilha_montagem,
+                                  &tcb_montagem);
+    xDisplay = xTaskCreateStatic(vDisplayTask, "Display Task", count_of(pilha_display), NULL, 1, pilha_display,
+                                 &tcb_display);
+    xGravacao = xTaskCreateStatic(vGravacaoTask, "Gravacao Task", count_of(pilha_gravacao), NULL, 1, pilha_gravacao,
+                                  &tcb_gravacao);
+    xJoystick = xTaskCreateStatic(vJoystickTask, "Joystick Task", count_of(pilha_joystick), NULL, 1, pilha_joystick,
+                                  &tcb_joystick);
+    xConsole = xTaskCreateStatic(vConsoleTask, "Console Task", count_of(pilha_console), NULL, 1, pilha_console,
+                                 &tcb_console);
 
-    xTaskCreate(vCapturaTask, "Captura Task", 512, NULL, 1, NULL);
-    xTaskCreate(vLedsTask, "Leds Task", 256, NULL, 1, NULL);
-    xTaskCreate(vMontagemTask, "Montagem Task", 512, NULL, 1, NULL);
-    xTaskCreate(vDisplayTask, "Display Task", 512, NULL, 1, NULL);
+#if configUSE_CORE_AFFINITY
+    // Núcleo 0: aquisição e interface; núcleo 1: formatação, compressão e SD
+    vTaskCoreAffinitySet(xEstado, NUCLEO_AQUISICAO);
+    vTaskCoreAffinitySet(xCaptura, NUCLEO_AQUISICAO);
+    vTaskCoreAffinitySet(xLeds, NUCLEO_AQUISICAO);
+    vTaskCoreAffinitySet(xDisplay, NUCLEO_AQUISICAO);
+    vTaskCoreAffinitySet(xJoystick, NUCLEO_AQUISICAO);
+    vTaskCoreAffinitySet(xMontagem, NUCLEO_ARMAZENAMENTO);
+    vTaskCoreAffinitySet(xGravacao, NUCLEO_ARMAZENAMENTO);
+    vTaskCoreAffinitySet(xConsole, NUCLEO_ARMAZENAMENTO);
+#endif
 
     // Inicia o agendador
     vTaskStartScheduler();
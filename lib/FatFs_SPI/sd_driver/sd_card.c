@@ -174,6 +174,8 @@ specific language governing permissions and limitations under the License.
 #include "ff.h" /* Obtains integer types */
 //
 #include "diskio.h" /* Declarations of disk functions */  // Needed for STA_NOINIT, ...
+//
+#include "trace.h"
 
 #ifndef SD_CRC_ENABLED
 #define SD_CRC_ENABLED 1
@@ -294,7 +296,7 @@ typedef enum {
 
 #define SPI_CMD(x) (0x40 | (x & 0x3f))
 
-static uint8_t sd_cmd_spi(sd_card_t *pSD, cmdSupported cmd, uint32_t arg) {
+static uint8_t __not_in_flash_func(sd_cmd_spi)(sd_card_t *pSD, cmdSupported cmd, uint32_t arg) {
     uint8_t response;
     char cmdPacket[PACKET_SIZE];
 
@@ -346,16 +348,18 @@ static uint8_t sd_cmd_spi(sd_card_t *pSD, cmdSupported cmd, uint32_t arg) {
     return response;
 }
 
-static bool sd_wait_ready(sd_card_t *pSD, int timeout) {
+static bool __not_in_flash_func(sd_wait_ready)(sd_card_t *pSD, int timeout) {
     char resp;
 
     // Keep sending dummy clocks with DI held high until the card releases the
     // DO line
+    TRACE_INICIO(TRACE_SD_OCUPADO, 0);
     absolute_time_t timeout_time = make_timeout_time_ms(timeout);
     do {
         resp = sd_spi_write(pSD, 0xFF);
     } while (resp == 0x00 &&
              0 < absolute_time_diff_us(get_absolute_time(), timeout_time));
+    TRACE_FIM(TRACE_SD_OCUPADO, (uint8_t)resp);
 
     if (resp == 0x00) DBG_PRINTF("%s failed\r\n", __FUNCTION__);
 
@@ -364,21 +368,21 @@ static bool sd_wait_ready(sd_card_t *pSD, int timeout) {
 }
 
 // An SD card can only do one thing at a time.
-static void sd_lock(sd_card_t *pSD) {
+static void __not_in_flash_func(sd_lock)(sd_card_t *pSD) {
     myASSERT(mutex_is_initialized(&pSD->mutex));
     mutex_enter_blocking(&pSD->mutex);
 }
-static void sd_unlock(sd_card_t *pSD) {
+static void __not_in_flash_func(sd_unlock)(sd_card_t *pSD) {
     myASSERT(mutex_is_initialized(&pSD->mutex));
     mutex_exit(&pSD->mutex);
 }
 
 // Locks the SD card and acquires its SPI
-static void sd_acquire(sd_card_t *pSD) {
+static void __not_in_flash_func(sd_acquire)(sd_card_t *pSD) {
     sd_lock(pSD);
     sd_spi_acquire(pSD);
 }
-static void sd_release(sd_card_t *pSD) {
+static void __not_in_flash_func(sd_release)(sd_card_t *pSD) {
     sd_unlock(pSD);
     sd_spi_release(pSD);
 }
@@ -450,8 +454,8 @@ static const char *cmd2str(const cmdSupported cmd) {
 #define SD_COMMAND_RETRIES 3 /*!< Times SPI cmd is retried when there is no response */
 #define SD_COMMAND_TIMEOUT 2000 /*!< Timeout in ms for response */
 
-static int sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
-                  bool isAcmd, uint32_t *resp) {
+static int __not_in_flash_func(sd_cmd)(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
+                                       bool isAcmd, uint32_t *resp) {
     TRACE_PRINTF("%s(%s(0x%08lx)): ", __FUNCTION__, cmd2str(cmd), arg);
 
     int32_t status = SD_BLOCK_DEVICE_ERROR_NONE;
@@ -898,11 +902,13 @@ int sd_read_blocks(sd_card_t *pSD, uint8_t *buffer, uint64_t ulSectorNumber,
     return status;
 }
 
-static uint8_t sd_write_block(sd_card_t *pSD, const uint8_t *buffer,
-                              uint8_t token, uint32_t length) {
+static uint8_t __not_in_flash_func(sd_write_block)(sd_card_t *pSD, const uint8_t *buffer,
+                                                   uint8_t token, uint32_t length) {
     uint16_t crc = (~0);
     uint8_t response = 0xFF;
 
+    TRACE_INICIO(TRACE_SD_BLOCO, token);
+
     // indicate start of block
     sd_spi_write(pSD, token);
 
@@ -928,6 +934,7 @@ static uint8_t sd_write_block(sd_card_t *pSD, const uint8_t *buffer,
     if (false == sd_wait_ready(pSD, SD_COMMAND_TIMEOUT)) {
         DBG_PRINTF("%s:%d: Card not ready yet\r\n", __FILE__, __LINE__);
     }
+    TRACE_FIM(TRACE_SD_BLOCO, response);
     return (response & SPI_DATA_RESPONSE_MASK);
 }
 
@@ -946,8 +953,8 @@ static uint8_t sd_write_block(sd_card_t *pSD, const uint8_t *buffer,
  *                  SD_BLOCK_DEVICE_ERROR_WRITE - SPI write error
  *                  SD_BLOCK_DEVICE_ERROR_ERASE - erase error
  */
-static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
-                              uint64_t ulSectorNumber, uint32_t blockCnt) {
+static int __not_in_flash_func(in_sd_write_blocks)(sd_card_t *pSD, const uint8_t *buffer,
+                                                   uint64_t ulSectorNumber, uint32_t blockCnt) {
     if (ulSectorNumber + blockCnt > pSD->sectors)
         return SD_BLOCK_DEVICE_ERROR_PARAMETER;
     if (pSD->m_Status & (STA_NOINIT | STA_NODISK))
@@ -1014,8 +1021,8 @@ static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
     return status;
 }
 
-int sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
-                    uint64_t ulSectorNumber, uint32_t blockCnt) {
+int __not_in_flash_func(sd_write_blocks)(sd_card_t *pSD, const uint8_t *buffer,
+                                         uint64_t ulSectorNumber, uint32_t blockCnt) {
     sd_acquire(pSD);
     TRACE_PRINTF("sd_write_blocks(0x%p, 0x%llx, 0x%lx)\r\n", buffer,
                  ulSectorNumber, blockCnt);
@@ -25,6 +25,7 @@ specific language governing permissions and limitations under the License.
 #include "ff.h"
 //
 #include "spi.h"
+#include "sd_latencia.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -54,6 +55,7 @@ struct sd_card_t {
     mutex_t mutex;
     FATFS fatfs;
     bool mounted;
+    sd_latencia_t lat_escrita;  // Latência de cada disk_write (ver sd_latencia.h)
 
     int (*init)(sd_card_t *sd_card_p);
     int (*write_blocks)(sd_card_t *sd_card_p, const uint8_t *buffer,
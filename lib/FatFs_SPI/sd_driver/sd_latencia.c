@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <string.h>
+//
+#include "pico/stdlib.h"
+#include "sd_latencia.h"
+
+void sd_latencia_zerar(sd_latencia_t *lat) {
+    memset(lat, 0, sizeof(*lat));
+}
+
+void __not_in_flash_func(sd_latencia_registrar)(sd_latencia_t *lat, uint32_t lat_us, uint32_t setores) {
+    uint32_t faixa = lat_us ? 32 - __builtin_clz(lat_us) : 0;
+    if (faixa >= SD_LAT_FAIXAS)
+        faixa = SD_LAT_FAIXAS - 1;
+    lat->hist[faixa]++;
+    lat->comandos++;
+    lat->setores += setores;
+    lat->soma_us += lat_us;
+    if (lat_us > lat->lat_max_us)
+        lat->lat_max_us = lat_us;
+}
+
+uint32_t sd_latencia_percentil(const sd_latencia_t *lat, uint16_t por_mil) {
+    uint32_t alvo = (uint32_t)(((uint64_t)lat->comandos * por_mil + 999) / 1000);
+    uint32_t acumulado = 0;
+    for (int i = 0; i < SD_LAT_FAIXAS - 1; i++) {
+        acumulado += lat->hist[i];
+        if (acumulado >= alvo)
+            return (1u << i) < lat->lat_max_us ? (1u << i) : lat->lat_max_us;
+    }
+    return lat->lat_max_us;
+}
+
+void sd_latencia_imprimir_hist(const sd_latencia_t *lat) {
+    for (int i = 0; i < SD_LAT_FAIXAS; i++) {
+        if (lat->hist[i] == 0)
+            continue;
+        if (i == SD_LAT_FAIXAS - 1)
+            printf(" >=%lu:%lu", 1ul << (i - 1), (unsigned long)lat->hist[i]);
+        else
+            printf(" <%lu:%lu", 1ul << i, (unsigned long)lat->hist[i]);
+    }
+    printf("\n");
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Histograma de latência dos comandos de escrita do cartão, em escala log2:
+// a faixa i conta comandos com latência em [2^(i-1), 2^i) µs e a última
+// acumula tudo acima (2^18 µs = 262 ms). Cada chamada de disk_write (um
+// comando CMD24/CMD25 com 'setores' setores) é registrada em
+// sd_card_t.lat_escrita.
+#define SD_LAT_FAIXAS 20
+
+typedef struct {
+    uint32_t hist[SD_LAT_FAIXAS];
+    uint32_t comandos;
+    uint32_t setores;
+    uint32_t lat_max_us;
+    uint64_t soma_us;
+} sd_latencia_t;
+
+void sd_latencia_zerar(sd_latencia_t *lat);
+void sd_latencia_registrar(sd_latencia_t *lat, uint32_t lat_us, uint32_t setores);
+
+// Latência (limite superior da faixa, em µs, limitado ao máximo observado)
+// abaixo da qual estão 'pct' por mil dos comandos (ex.: 990 para o p99)
+uint32_t sd_latencia_percentil(const sd_latencia_t *lat, uint16_t por_mil);
+
+// Imprime as faixas não vazias em uma linha: " <2:10 <4:3 ... >=262144:1"
+void sd_latencia_imprimir_hist(const sd_latencia_t *lat);
+
+#ifdef __cplusplus
+}
+#endif
@@ -41,15 +41,15 @@ void sd_spi_go_low_frequency(sd_card_t *pSD) {
 
 #pragma GCC diagnostic pop
 
-static void sd_spi_lock(sd_card_t *pSD) {
+static void __not_in_flash_func(sd_spi_lock)(sd_card_t *pSD) {
     spi_lock(pSD->spi);
 }
-static void sd_spi_unlock(sd_card_t *pSD) {
+static void __not_in_flash_func(sd_spi_unlock)(sd_card_t *pSD) {
    spi_unlock(pSD->spi);
 }
 
 // Would do nothing if pSD->ss_gpio were set to GPIO_FUNC_SPI.
-static void sd_spi_select(sd_card_t *pSD) {
+static void __not_in_flash_func(sd_spi_select)(sd_card_t *pSD) {
     gpio_put(pSD->ss_gpio, 0);
     // A fill byte seems to be necessary, sometimes:
     uint8_t fill = SPI_FILL_CHAR;
@@ -57,7 +57,7 @@ static void sd_spi_select(sd_card_t *pSD) {
     LED_ON();
 }
 
-static void sd_spi_deselect(sd_card_t *pSD) {
+static void __not_in_flash_func(sd_spi_deselect)(sd_card_t *pSD) {
     gpio_put(pSD->ss_gpio, 1);
     LED_OFF();
     /*
@@ -71,27 +71,27 @@ static void sd_spi_deselect(sd_card_t *pSD) {
     spi_write_blocking(pSD->spi->hw_inst, &fill, 1);
 }
 /* Some SD cards want to be deselected between every bus transaction */
-void sd_spi_deselect_pulse(sd_card_t *pSD) {
+void __not_in_flash_func(sd_spi_deselect_pulse)(sd_card_t *pSD) {
     sd_spi_deselect(pSD);
     // tCSH Pulse duration, CS high 200 ns
     sd_spi_select(pSD);
 }
-void sd_spi_acquire(sd_card_t *pSD) {
+void __not_in_flash_func(sd_spi_acquire)(sd_card_t *pSD) {
     sd_spi_lock(pSD);
     sd_spi_select(pSD);
 }
 
-void sd_spi_release(sd_card_t *pSD) {
+void __not_in_flash_func(sd_spi_release)(sd_card_t *pSD) {
     sd_spi_deselect(pSD);
     sd_spi_unlock(pSD);
 }
 
-bool sd_spi_transfer(sd_card_t *pSD, const uint8_t *tx, uint8_t *rx,
-                     size_t length) {
+bool __not_in_flash_func(sd_spi_transfer)(sd_card_t *pSD, const uint8_t *tx, uint8_t *rx,
+                                          size_t length) {
     return spi_transfer(pSD->spi, tx, rx, length);
 }
 
-uint8_t sd_spi_write(sd_card_t *pSD, const uint8_t value) {
+uint8_t __not_in_flash_func(sd_spi_write)(sd_card_t *pSD, const uint8_t value) {
     // TRACE_PRINTF("%s\n", __FUNCTION__);
     uint8_t received = SPI_FILL_CHAR;
 #if 0
@@ -23,11 +23,13 @@ specific language governing permissions and limitations under the License.
 #include "hw_config.h"
 //
 #include "spi.h"
+#include "trace.h"
+#include "caminho_quente.h"
 
 static bool irqChannel1 = false;
 static bool irqShared = true;
 
-static void in_spi_irq_handler(const uint DMA_IRQ_num, io_rw_32 *dma_hw_ints_p) {
+static void __not_in_flash_func(in_spi_irq_handler)(const uint DMA_IRQ_num, io_rw_32 *dma_hw_ints_p) {
     for (size_t i = 0; i < spi_get_num(); ++i) {
         spi_t *spi_p = spi_get_by_num(i);
         if (DMA_IRQ_num == spi_p->DMA_IRQ_num)  {
@@ -109,12 +111,14 @@ bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
 
     // start them exactly simultaneously to avoid races (in extreme cases
     // the FIFO could overflow)
+    TRACE_INICIO(TRACE_SPI_DMA, length);
     dma_start_channel_mask((1u << spi_p->tx_dma) | (1u << spi_p->rx_dma));
 
     /* Wait until master completes transfer or time out has occured. */
     uint32_t timeOut = 1000; /* Timeout 1 sec */
     bool rc = sem_acquire_timeout_ms(
         &spi_p->sem, timeOut);  // Wait for notification from ISR
+    TRACE_FIM(TRACE_SPI_DMA, rc);
     if (!rc) {
         // If the timeout is reached the function will return false
         DBG_PRINTF("Notification wait timed out in %s\n", __FUNCTION__);
@@ -131,11 +135,11 @@ bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
     return true;
 }
 
-void spi_lock(spi_t *spi_p) {
+void CAMINHO_QUENTE(spi_lock)(spi_t *spi_p) {
     assert(mutex_is_initialized(&spi_p->mutex));
     mutex_enter_blocking(&spi_p->mutex);
 }
-void spi_unlock(spi_t *spi_p) {
+void CAMINHO_QUENTE(spi_unlock)(spi_t *spi_p) {
     assert(mutex_is_initialized(&spi_p->mutex));
     mutex_exit(&spi_p->mutex);
 }
@@ -21,6 +21,8 @@ specific language governing permissions and limitations under the License.
 /*-----------------------------------------------------------------------*/
 #include <stdio.h>
 //
+#include "pico/stdlib.h"
+//
 #include "ff.h" /* Obtains integer types */
 //
 #include "diskio.h" /* Declarations of disk functions */
@@ -108,15 +110,17 @@ DRESULT disk_read(BYTE pdrv,  /* Physical drive nmuber to identify the drive */
 
 #if FF_FS_READONLY == 0
 
-DRESULT disk_write(BYTE pdrv, /* Physical drive nmuber to identify the drive */
-                   const BYTE *buff, /* Data to be written */
-                   LBA_t sector,     /* Start sector in LBA */
-                   UINT count        /* Number of sectors to write */
+DRESULT __not_in_flash_func(disk_write)(BYTE pdrv, /* Physical drive nmuber to identify the drive */
+                                        const BYTE *buff, /* Data to be written */
+                                        LBA_t sector,     /* Start sector in LBA */
+                                        UINT count        /* Number of sectors to write */
 ) {
     TRACE_PRINTF(">>> %s\n", __FUNCTION__);
     sd_card_t *p_sd = sd_get_by_num(pdrv);
     if (!p_sd) return RES_PARERR;
+    uint32_t inicio = time_us_32();
     int rc = p_sd->write_blocks(p_sd, buff, sector, count);
+    sd_latencia_registrar(&p_sd->lat_escrita, time_us_32() - inicio, count);
     return sdrc2dresult(rc);
 }
 
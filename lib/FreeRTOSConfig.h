@@ -69,9 +69,11 @@
  #define configMESSAGE_BUFFER_LENGTH_TYPE        size_t
  
  /* Memory allocation related definitions. */
- #define configSUPPORT_STATIC_ALLOCATION         0
+ /* Objetos de vida longa na arena estática (lib/arena.h); o heap fica para
+    usos temporários, como o comando "tarefas" */
+ #define configSUPPORT_STATIC_ALLOCATION         1
  #define configSUPPORT_DYNAMIC_ALLOCATION        1
- #define configTOTAL_HEAP_SIZE                   (128*1024)
+ #define configTOTAL_HEAP_SIZE                   (16*1024)
  #define configAPPLICATION_ALLOCATED_HEAP        0
  
  /* Hook function related definitions. */
@@ -80,10 +82,19 @@
  #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
  
  /* Run time and task stats gathering related definitions. */
- #define configGENERATE_RUN_TIME_STATS           0
+ #define configGENERATE_RUN_TIME_STATS           1
  #define configUSE_TRACE_FACILITY                1
  #define configUSE_STATS_FORMATTING_FUNCTIONS    0
  
+ /* Tempo de execução por tarefa em µs, contado pelo timer do RP2040 (64 bits,
+    não estoura); o comando "tarefas" do console mostra a tabela */
+ #define configRUN_TIME_COUNTER_TYPE             uint64_t
+ #ifndef __ASSEMBLER__
+ extern uint64_t time_us_64(void);
+ #endif
+ #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() /* o timer já roda desde o boot */
+ #define portGET_RUN_TIME_COUNTER_VALUE()        time_us_64()
+ 
  /* Co-routine related definitions. */
  #define configUSE_CO_ROUTINES                   0
  #define configMAX_CO_ROUTINE_PRIORITIES         1
@@ -102,9 +113,12 @@
  */
  
  /* SMP port only */
- #define configNUM_CORES                         1
- #define configTICK_CORE                         1
+ #define configNUM_CORES                         2
+ #define configNUMBER_OF_CORES                   configNUM_CORES
+ #define configTICK_CORE                         0
  #define configRUN_MULTIPLE_PRIORITIES           1
+ #define configUSE_CORE_AFFINITY                 1
+ #define configUSE_PASSIVE_IDLE_HOOK             0
  
  /* RP2040 specific */
  #define configSUPPORT_PICO_SYNC_INTEROP         1
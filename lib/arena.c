@@ -0,0 +1,39 @@
+#include "arena.h"
+#include "task.h"
+
+// Memória das tarefas do próprio kernel (Idle e Timer), pedida pelo FreeRTOS
+// quando configSUPPORT_STATIC_ALLOCATION = 1
+
+TAREFA_ESTATICA(idle, configMINIMAL_STACK_SIZE);
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **tcb, StackType_t **pilha, configSTACK_DEPTH_TYPE *profundidade)
+{
+    *tcb = &tcb_idle;
+    *pilha = pilha_idle;
+    *profundidade = configMINIMAL_STACK_SIZE;
+}
+
+#if configNUMBER_OF_CORES > 1
+// Idle dos demais núcleos (FreeRTOS SMP)
+static StackType_t pilha_idle_passiva[configNUMBER_OF_CORES - 1][configMINIMAL_STACK_SIZE] ARENA;
+static StaticTask_t tcb_idle_passiva[configNUMBER_OF_CORES - 1] ARENA;
+
+void vApplicationGetPassiveIdleTaskMemory(StaticTask_t **tcb, StackType_t **pilha,
+                                          configSTACK_DEPTH_TYPE *profundidade, BaseType_t indice)
+{
+    *tcb = &tcb_idle_passiva[indice];
+    *pilha = pilha_idle_passiva[indice];
+    *profundidade = configMINIMAL_STACK_SIZE;
+}
+#endif
+
+#if configUSE_TIMERS
+TAREFA_ESTATICA(timer, configTIMER_TASK_STACK_DEPTH);
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **tcb, StackType_t **pilha, configSTACK_DEPTH_TYPE *profundidade)
+{
+    *tcb = &tcb_timer;
+    *pilha = pilha_timer;
+    *profundidade = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
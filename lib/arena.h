@@ -0,0 +1,29 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+
+// Arena estática: os objetos que vivem enquanto o firmware roda (pilhas e
+// TCBs das tarefas, filas, semáforos, bloco de staging, framebuffer do
+// display e o FIL do log) ficam na seção .bss.arena, com tamanho fixado na
+// compilação. O heap do FreeRTOS fica só para usos temporários (comando
+// "tarefas"), então o uso de memória não muda nem fragmenta em capturas
+// longas. O total aparece em Datalogger.elf.map, procurando .bss.arena.
+#define ARENA __attribute__((section(".bss.arena")))
+
+// Bancos de 4 KB fora da SRAM intercalada (SRAM0-3), acessados só por quem
+// usa o buffer ali posto. Cada um divide o espaço com a pilha de exceções de
+// um núcleo (2 KB: núcleo 1 no SRAM4, núcleo 0 no SRAM5), então recebem só
+// buffers pequenos e quentes; se passar, o linker acusa "region SCRATCH_X
+// (ou SCRATCH_Y) overflowed".
+#define ARENA_SRAM4 __scratch_x("arena") // armazenamento (núcleo 1): setores do FatFs
+#define ARENA_SRAM5 __scratch_y("arena") // aquisição (núcleo 0): fila de amostras
+
+// Pilha e TCB de uma tarefa criada com xTaskCreateStatic (profundidade em
+// palavras, como no xTaskCreate)
+#define TAREFA_ESTATICA(nome, profundidade)               \
+    static StackType_t pilha_##nome[profundidade] ARENA; \
+    static StaticTask_t tcb_##nome ARENA
+
+#endif
@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "bench_sd.h"
+#include "sd_spi.h"
+#include "arena.h"
+
+#define BENCH_ARQUIVO "bench.bin"
+#define BENCH_PREENCHIMENTO "bench_frag.bin" // ocupa um cluster a cada dois
+#define BENCH_TEMP "bench_tmp.bin"
+#define BENCH_TOTAL (256 * 1024)             // bytes por caso da varredura
+#define BENCH_TAM_REF 4096                   // escrita de referência (bloco de staging)
+
+// Dados das escritas, na arena: o benchmark não usa o heap
+static uint8_t buf_bench[BENCH_TAM_MAX] ARENA;
+
+static const char *nomes_modo[] = {"anexar", "contiguo", "fragment"};
+
+// Contagem dos setores que chegam ao driver: os ponteiros de bloco do cartão
+// são trocados por estes durante a medição
+static int (*write_original)(sd_card_t *, const uint8_t *, uint64_t, uint32_t);
+static int (*read_original)(sd_card_t *, uint8_t *, uint64_t, uint32_t);
+static uint32_t setores_escritos, setores_lidos;
+
+static int contar_escrita(sd_card_t *sd, const uint8_t *buffer, uint64_t setor, uint32_t n)
+{
+    setores_escritos += n;
+    return write_original(sd, buffer, setor, n);
+}
+
+static int contar_leitura(sd_card_t *sd, uint8_t *buffer, uint64_t setor, uint32_t n)
+{
+    setores_lidos += n;
+    return read_original(sd, buffer, setor, n);
+}
+
+static void instalar_contadores(sd_card_t *sd)
+{
+    setores_escritos = setores_lidos = 0;
+    write_original = sd->write_blocks;
+    read_original = sd->read_blocks;
+    sd->write_blocks = contar_escrita;
+    sd->read_blocks = contar_leitura;
+}
+
+static void remover_contadores(sd_card_t *sd)
+{
+    sd->write_blocks = write_original;
+    sd->read_blocks = read_original;
+}
+
+// Escreve 'n' bytes em um arquivo reaproveitando o buffer do caso
+static FRESULT escrever_n(FIL *fil, const uint8_t *buf, uint32_t tam_buf, uint32_t n)
+{
+    UINT bw;
+    while (n > 0)
+    {
+        UINT parte = n < tam_buf ? n : tam_buf;
+        FRESULT fr = f_write(fil, buf, parte, &bw);
+        if (fr != FR_OK)
+            return fr;
+        if (bw != parte)
+            return FR_DENIED; // volume cheio
+        n -= parte;
+    }
+    return FR_OK;
+}
+
+// Fragmenta o espaço livre: dois arquivos crescem alternadamente um cluster
+// por vez e o primeiro é apagado, deixando buracos de um cluster.
+static FRESULT fragmentar(sd_card_t *sd, uint32_t total, const uint8_t *buf, uint32_t tam_buf)
+{
+    uint32_t cluster = (uint32_t)sd->fatfs.csize * FF_MAX_SS;
+    FIL a, b;
+    FRESULT fr = f_open(&a, BENCH_TEMP, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK)
+        return fr;
+    fr = f_open(&b, BENCH_PREENCHIMENTO, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK)
+    {
+        f_close(&a);
+        return fr;
+    }
+    for (uint32_t n = 0; n < total + cluster && fr == FR_OK; n += cluster)
+    {
+        fr = escrever_n(&a, buf, tam_buf, cluster);
+        if (fr == FR_OK)
+            fr = escrever_n(&b, buf, tam_buf, cluster);
+    }
+    f_close(&a);
+    f_close(&b);
+    f_unlink(BENCH_TEMP);
+    return fr;
+}
+
+FRESULT bench_sd_caso(sd_card_t *sd, const bench_caso_t *caso, bench_resultado_t *res)
+{
+    memset(res, 0, sizeof(*res));
+    if (caso->tam_escrita == 0 || caso->tam_escrita > BENCH_TAM_MAX)
+        return res->erro = FR_INVALID_PARAMETER;
+    uint8_t *buf = buf_bench;
+    for (uint32_t i = 0; i < caso->tam_escrita; i++)
+        buf[i] = (uint8_t)('0' + i % 64); // texto, como o CSV
+
+    uint baud_original = sd->spi->baud_rate;
+    if (caso->spi_hz)
+    {
+        sd->spi->baud_rate = caso->spi_hz;
+        sd_spi_go_high_frequency(sd);
+    }
+
+    FIL fil;
+    FRESULT fr = FR_OK;
+    if (caso->modo == BENCH_FRAGMENTADO)
+        fr = fragmentar(sd, caso->total, buf, caso->tam_escrita);
+    if (fr == FR_OK)
+        fr = f_open(&fil, BENCH_ARQUIVO, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr == FR_OK && caso->modo == BENCH_CONTIGUO)
+    {
+        fr = f_expand(&fil, caso->total, 1);
+        if (fr != FR_OK)
+            f_close(&fil);
+    }
+
+    if (fr == FR_OK)
+    {
+        instalar_contadores(sd);
+        uint32_t inicio = time_us_32();
+        while (res->bytes < caso->total && fr == FR_OK)
+        {
+            uint32_t n = caso->total - res->bytes;
+            if (n > caso->tam_escrita)
+                n = caso->tam_escrita;
+
+            UINT bw;
+            uint32_t t = time_us_32();
+            fr = f_write(&fil, buf, n, &bw);
+            if (fr == FR_OK && caso->intervalo_sync && (res->lat.comandos + 1) % caso->intervalo_sync == 0)
+                fr = f_sync(&fil);
+            sd_latencia_registrar(&res->lat, time_us_32() - t, 0);
+
+            if (fr == FR_OK && bw != n)
+                fr = FR_DENIED; // volume cheio
+            res->bytes += bw;
+        }
+        FRESULT fr_close = f_close(&fil);
+        if (fr == FR_OK)
+            fr = fr_close;
+        res->tempo_us = time_us_32() - inicio;
+        res->setores_escritos = setores_escritos;
+        res->setores_lidos = setores_lidos;
+        remover_contadores(sd);
+    }
+
+    f_unlink(BENCH_ARQUIVO);
+    if (caso->modo == BENCH_FRAGMENTADO)
+        f_unlink(BENCH_PREENCHIMENTO);
+
+    if (caso->spi_hz)
+    {
+        sd->spi->baud_rate = baud_original;
+        sd_spi_go_high_frequency(sd);
+    }
+    return res->erro = fr;
+}
+
+static void imprimir(const bench_caso_t *caso, const bench_resultado_t *res, uint baud)
+{
+    if (res->erro != FR_OK)
+    {
+        printf("[BENCH] %6lu %4lu %-8s %6lu  erro %d\n", (unsigned long)caso->tam_escrita,
+               (unsigned long)caso->intervalo_sync, nomes_modo[caso->modo], (unsigned long)(baud / 1000), res->erro);
+        return;
+    }
+
+    // bytes/µs = MB/s; amplificação = bytes entregues ao cartão / bytes lógicos
+    float mbs = res->tempo_us ? (float)res->bytes / res->tempo_us : 0.0f;
+    float setores_byte = res->bytes ? (float)res->setores_escritos / res->bytes : 0.0f;
+    printf("[BENCH] %6lu %4lu %-8s %6lu %7.3f %7lu %7lu %7lu %8.5f %6.2f %5lu\n", (unsigned long)caso->tam_escrita,
+           (unsigned long)caso->intervalo_sync, nomes_modo[caso->modo], (unsigned long)(baud / 1000), mbs,
+           (unsigned long)sd_latencia_percentil(&res->lat, 500), (unsigned long)sd_latencia_percentil(&res->lat, 990),
+           (unsigned long)res->lat.lat_max_us, setores_byte, setores_byte * FF_MAX_SS, (unsigned long)res->setores_lidos);
+
+    printf("[BENCH]   lat_us");
+    sd_latencia_imprimir_hist(&res->lat);
+}
+
+static void rodar(sd_card_t *sd, uint32_t tam, uint32_t sync, bench_modo_t modo, uint32_t spi_hz)
+{
+    bench_caso_t caso = {tam, sync, modo, spi_hz, BENCH_TOTAL};
+    bench_resultado_t res;
+    bench_sd_caso(sd, &caso, &res);
+    imprimir(&caso, &res, spi_hz ? spi_hz : sd->spi->baud_rate);
+}
+
+// Varre um fator por vez em torno da referência (escrita de 4 KB, sem sync,
+// anexando, clock atual), para que cada tabela isole o efeito de um fator
+void bench_sd_executar(sd_card_t *sd)
+{
+    static const uint32_t clocks_spi[] = {1000000, 5000000, 12500000, 25000000};
+    static const uint32_t intervalos_sync[] = {1, 8, 64};
+
+    printf("[BENCH] %lu KB por caso, cluster de %lu bytes\n", (unsigned long)(BENCH_TOTAL / 1024),
+           (unsigned long)sd->fatfs.csize * FF_MAX_SS);
+    printf("[BENCH]    tam sync modo     spi_kHz    MB/s  p50_us  p99_us  max_us  set/byte amplif lidos\n");
+
+    for (uint32_t tam = 64; tam <= BENCH_TAM_MAX; tam *= 2)
+        rodar(sd, tam, 0, BENCH_ANEXAR, 0);
+    for (size_t i = 0; i < count_of(intervalos_sync); i++)
+    {
+        rodar(sd, 512, intervalos_sync[i], BENCH_ANEXAR, 0);
+        rodar(sd, BENCH_TAM_REF, intervalos_sync[i], BENCH_ANEXAR, 0);
+    }
+    rodar(sd, BENCH_TAM_REF, 0, BENCH_CONTIGUO, 0);
+    rodar(sd, BENCH_TAM_REF, 0, BENCH_FRAGMENTADO, 0);
+    for (size_t i = 0; i < count_of(clocks_spi); i++)
+        rodar(sd, BENCH_TAM_REF, 0, BENCH_ANEXAR, clocks_spi[i]);
+
+    printf("[BENCH] Fim\n");
+}
@@ -0,0 +1,49 @@
+#ifndef BENCH_SD_H
+#define BENCH_SD_H
+
+#include <stdint.h>
+#include "ff.h"
+#include "sd_card.h"
+
+// Benchmark da pilha de armazenamento: f_write -> disk_write -> write_blocks.
+// Cada caso grava 'total' bytes em bench.bin com escritas de 'tam_escrita'
+// bytes e mede a vazão, a latência de cada chamada e quantos setores chegam
+// ao cartão por byte lógico gravado. Roda no RP2040 (comando "bench" do
+// console USB) e no simulador do PC (SIM_BENCH=1).
+
+typedef enum
+{
+    BENCH_ANEXAR,      // arquivo novo crescendo a cada escrita (como o log)
+    BENCH_CONTIGUO,    // arquivo pré-alocado em clusters contíguos (f_expand)
+    BENCH_FRAGMENTADO  // espaço livre fragmentado: um cluster livre a cada dois
+} bench_modo_t;
+
+#define BENCH_TAM_MAX (32 * 1024) // maior escrita de um caso (buffer estático)
+
+typedef struct
+{
+    uint32_t tam_escrita;    // bytes por f_write (até BENCH_TAM_MAX)
+    uint32_t intervalo_sync; // f_sync a cada N escritas (0: só no f_close)
+    bench_modo_t modo;
+    uint32_t spi_hz;         // clock do SPI durante o caso (0: mantém o atual)
+    uint32_t total;          // bytes gravados no caso
+} bench_caso_t;
+
+typedef struct
+{
+    uint32_t bytes;
+    uint32_t tempo_us;         // da primeira escrita ao f_close
+    uint32_t setores_escritos; // setores entregues a write_blocks
+    uint32_t setores_lidos;    // setores lidos de read_blocks (FAT, diretório)
+    sd_latencia_t lat;         // por chamada: f_write mais o f_sync, quando houver
+    FRESULT erro;
+} bench_resultado_t;
+
+// Executa um caso no volume já montado de 'sd'
+FRESULT bench_sd_caso(sd_card_t *sd, const bench_caso_t *caso, bench_resultado_t *res);
+
+// Roda a varredura completa (tamanhos de escrita, intervalos de sync, modos
+// de alocação e clocks do SPI) e imprime uma linha por caso.
+void bench_sd_executar(sd_card_t *sd);
+
+#endif
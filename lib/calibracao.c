@@ -0,0 +1,416 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ff.h"
+#include "calibracao.h"
+#include "config.h"
+#include "sensores.h"
+#include "caminho_quente.h"
+
+#define CALIB_GIRO_RUIDO_DPS 2.0 // desvio padrão máximo do giroscópio parado
+#define CALIB_ACEL_RUIDO_G 0.05  // desvio padrão máximo do acelerômetro parado
+#define CALIB_GANHO_MIN (1 << (CALIB_Q - 1)) // 0,5: sensibilidade fora disso é erro de posição
+#define CALIB_GANHO_MAX INT16_MAX            // ~2,0
+
+// Calibração medida, no fundo de escala da medição (o que vai para o arquivo)
+typedef struct
+{
+    bool tem_giro;
+    uint16_t giro_dps;
+    int16_t giro_bias[3];
+    bool tem_acel;
+    uint8_t acel_g;
+    int16_t acel_offset[3];
+    int16_t acel_ganho[3]; // Q2.14
+} calib_sensor_t;
+
+// Correção em uso pela captura, já no fundo de escala configurado
+typedef struct
+{
+    bool ativa;
+    int16_t giro_bias[3];
+    int16_t acel_offset[3];
+    int32_t acel_ganho[3];
+} correcao_t;
+
+// Somas de uma coleta: 0..2 acelerômetro, 3..5 giroscópio
+typedef struct
+{
+    int64_t soma[6];
+    int64_t soma2[6];
+    uint32_t n;
+} coleta_t;
+
+// Médias do acelerômetro nas seis posições, até todas serem medidas
+typedef struct
+{
+    uint8_t feitas; // bit por calib_posicao_t
+    uint8_t acel_g;
+    int16_t media[CALIB_POSICOES][3];
+} posicoes_t;
+
+static calib_sensor_t calib[SENSORES_MAX];
+static correcao_t correcao[SENSORES_MAX];
+static coleta_t coleta[SENSORES_MAX];
+static volatile bool coletando = false;
+static posicoes_t posicoes[SENSORES_MAX];
+
+static const char *const nomes_posicao[CALIB_POSICOES] = {"+x", "-x", "+y", "-y", "+z", "-z"};
+
+int calibracao_posicao(const char *nome)
+{
+    for (int i = 0; i < CALIB_POSICOES; i++)
+        if (strcmp(nome, nomes_posicao[i]) == 0)
+            return i;
+    return -1;
+}
+
+// v * num / den arredondado ao inteiro mais próximo e saturado em int16
+static int16_t escalar(int32_t v, int32_t num, int32_t den)
+{
+    int64_t r = (int64_t)v * num;
+    r = (r >= 0 ? r + den / 2 : r - den / 2) / den;
+    if (r > INT16_MAX)
+        return INT16_MAX;
+    if (r < INT16_MIN)
+        return INT16_MIN;
+    return (int16_t)r;
+}
+
+static inline int16_t saturar(int32_t v)
+{
+    return v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : (int16_t)v;
+}
+
+void calibracao_zerar(void)
+{
+    memset(calib, 0, sizeof(calib));
+    memset(posicoes, 0, sizeof(posicoes));
+}
+
+void calibracao_preparar(const sensor_t *s)
+{
+    const calib_sensor_t *c = &calib[s->id % SENSORES_MAX];
+    correcao_t *k = &correcao[s->id % SENSORES_MAX];
+    memset(k, 0, sizeof(*k));
+    for (int i = 0; i < 3; i++)
+        k->acel_ganho[i] = 1 << CALIB_Q;
+
+    // Em contagens, offset e bias são inversamente proporcionais ao fundo de escala
+    if (c->tem_giro && s->config.giro_dps)
+        for (int i = 0; i < 3; i++)
+            k->giro_bias[i] = escalar(c->giro_bias[i], c->giro_dps, s->config.giro_dps);
+    if (c->tem_acel && s->config.acel_g)
+        for (int i = 0; i < 3; i++)
+        {
+            k->acel_offset[i] = escalar(c->acel_offset[i], c->acel_g, s->config.acel_g);
+            k->acel_ganho[i] = c->acel_ganho[i];
+        }
+    k->ativa = c->tem_giro || c->tem_acel;
+}
+
+void CAMINHO_QUENTE(calibracao_aplicar)(uint8_t id, sensor_leitura_t *l)
+{
+    const correcao_t *k = &correcao[id % SENSORES_MAX];
+    if (!k->ativa)
+        return;
+    for (int i = 0; i < 3; i++)
+    {
+        l->giro[i] = saturar((int32_t)l->giro[i] - k->giro_bias[i]);
+        l->acel[i] = saturar((((int32_t)l->acel[i] - k->acel_offset[i]) * k->acel_ganho[i]) >> CALIB_Q);
+    }
+}
+
+void calibracao_coleta_iniciar(void)
+{
+    memset(coleta, 0, sizeof(coleta));
+    coletando = true;
+}
+
+void calibracao_coleta_parar(void)
+{
+    coletando = false;
+}
+
+void CAMINHO_QUENTE(calibracao_acumular)(uint8_t id, const sensor_leitura_t *l)
+{
+    if (!coletando)
+        return;
+    coleta_t *c = &coleta[id % SENSORES_MAX];
+    for (int i = 0; i < 3; i++)
+    {
+        c->soma[i] += l->acel[i];
+        c->soma2[i] += (int32_t)l->acel[i] * l->acel[i];
+        c->soma[i + 3] += l->giro[i];
+        c->soma2[i + 3] += (int32_t)l->giro[i] * l->giro[i];
+    }
+    c->n++;
+}
+
+// Média (arredondada) e desvio padrão do canal 'i' da coleta
+static int16_t media_canal(const coleta_t *c, int i, double *desvio)
+{
+    double media = (double)c->soma[i] / c->n;
+    double var = (double)c->soma2[i] / c->n - media * media;
+    *desvio = var > 0 ? sqrt(var) : 0;
+    return saturar((int32_t)lround(media));
+}
+
+bool calibracao_giro(const sensor_t *s)
+{
+    const coleta_t *c = &coleta[s->id % SENSORES_MAX];
+    if (c->n == 0)
+    {
+        printf("[CALIB] %u: nenhuma leitura\n", s->id);
+        return false;
+    }
+    float escala_acel, escala_giro;
+    s->driver->escalas(s, &escala_acel, &escala_giro);
+
+    int16_t bias[3];
+    for (int i = 0; i < 3; i++)
+    {
+        double desvio;
+        bias[i] = media_canal(c, i + 3, &desvio);
+        if (desvio > CALIB_GIRO_RUIDO_DPS * escala_giro)
+        {
+            printf("[CALIB] %u: giroscopio se mexeu (desvio %.2f dps no eixo %c), repita parado\n", s->id,
+                   desvio / escala_giro, 'x' + i);
+            return false;
+        }
+    }
+
+    calib_sensor_t *k = &calib[s->id % SENSORES_MAX];
+    k->tem_giro = true;
+    k->giro_dps = s->config.giro_dps;
+    memcpy(k->giro_bias, bias, sizeof(bias));
+    printf("[CALIB] %u: bias do giroscopio %d %d %d (%.2f %.2f %.2f dps), %lu leituras\n", s->id, bias[0], bias[1],
+           bias[2], bias[0] / escala_giro, bias[1] / escala_giro, bias[2] / escala_giro, (unsigned long)c->n);
+    return true;
+}
+
+// Offset e ganho de cada eixo a partir das leituras com o eixo para cima e
+// para baixo: o offset é o ponto médio e a sensibilidade, metade da distância
+static bool calcular_acel(const sensor_t *s, const posicoes_t *p, float escala_acel)
+{
+    int16_t offset[3], ganho[3];
+    for (int i = 0; i < 3; i++)
+    {
+        int32_t cima = p->media[2 * i][i];
+        int32_t baixo = p->media[2 * i + 1][i];
+        int32_t sensibilidade = (cima - baixo) / 2;
+        offset[i] = saturar((cima + baixo) / 2);
+        long g = sensibilidade > 0 ? lroundf(escala_acel * (1 << CALIB_Q) / sensibilidade) : 0;
+        if (g < CALIB_GANHO_MIN || g > CALIB_GANHO_MAX)
+        {
+            printf("[CALIB] %u: sensibilidade do eixo %c fora do esperado (%ld LSB/g), refaca as posicoes\n", s->id,
+                   'x' + i, (long)sensibilidade);
+            return false;
+        }
+        ganho[i] = (int16_t)g;
+    }
+
+    calib_sensor_t *k = &calib[s->id % SENSORES_MAX];
+    k->tem_acel = true;
+    k->acel_g = p->acel_g;
+    memcpy(k->acel_offset, offset, sizeof(offset));
+    memcpy(k->acel_ganho, ganho, sizeof(ganho));
+    printf("[CALIB] %u: acelerometro offset %d %d %d, ganho %.4f %.4f %.4f\n", s->id, offset[0], offset[1], offset[2],
+           ganho[0] / (float)(1 << CALIB_Q), ganho[1] / (float)(1 << CALIB_Q), ganho[2] / (float)(1 << CALIB_Q));
+    return true;
+}
+
+bool calibracao_acel(const sensor_t *s, calib_posicao_t posicao)
+{
+    const coleta_t *c = &coleta[s->id % SENSORES_MAX];
+    if (c->n == 0)
+    {
+        printf("[CALIB] %u: nenhuma leitura\n", s->id);
+        return false;
+    }
+    float escala_acel, escala_giro;
+    s->driver->escalas(s, &escala_acel, &escala_giro);
+
+    int16_t media[3];
+    for (int i = 0; i < 3; i++)
+    {
+        double desvio;
+        media[i] = media_canal(c, i, &desvio);
+        if (desvio > CALIB_ACEL_RUIDO_G * escala_acel)
+        {
+            printf("[CALIB] %u: acelerometro se mexeu (desvio %.3f g no eixo %c), repita parado\n", s->id,
+                   desvio / escala_acel, 'x' + i);
+            return false;
+        }
+    }
+
+    // O eixo da posição deve ler perto de +-1 g e os outros perto de zero
+    int eixo = posicao / 2;
+    float esperado = (posicao % 2) ? -1.0f : 1.0f;
+    for (int i = 0; i < 3; i++)
+    {
+        float g = media[i] / escala_acel;
+        if (fabsf(g - (i == eixo ? esperado : 0.0f)) > 0.5f)
+        {
+            printf("[CALIB] %u: leitura %.2f %.2f %.2f g nao confere com %s para cima\n", s->id,
+                   media[0] / escala_acel, media[1] / escala_acel, media[2] / escala_acel, nomes_posicao[posicao]);
+            return false;
+        }
+    }
+
+    // Todas as posições precisam do mesmo fundo de escala
+    posicoes_t *p = &posicoes[s->id % SENSORES_MAX];
+    if (p->feitas && p->acel_g != s->config.acel_g)
+        p->feitas = 0;
+    p->acel_g = s->config.acel_g;
+    memcpy(p->media[posicao], media, sizeof(media));
+    p->feitas |= 1u << posicao;
+
+    if (p->feitas != (1u << CALIB_POSICOES) - 1)
+    {
+        printf("[CALIB] %u: posicao %s medida, faltam", s->id, nomes_posicao[posicao]);
+        for (int i = 0; i < CALIB_POSICOES; i++)
+            if (!(p->feitas & (1u << i)))
+                printf(" %s", nomes_posicao[i]);
+        printf("\n");
+        return false;
+    }
+
+    bool ok = calcular_acel(s, p, escala_acel);
+    p->feitas = 0;
+    return ok;
+}
+
+// Lê até n inteiros separados por espaços. Retorna quantos leu.
+static int ler_inteiros(const char *valor, long *v, int n)
+{
+    int lidos = 0;
+    while (lidos < n)
+    {
+        char *fim;
+        v[lidos] = strtol(valor, &fim, 10);
+        if (fim == valor)
+            break;
+        lidos++;
+        valor = fim;
+    }
+    return lidos;
+}
+
+// Chaves fora de uma seção [sensorN] são ignoradas
+static void aplicar(void *ctx, const char *secao, const char *chave, const char *valor)
+{
+    unsigned id;
+    if (sscanf(secao, "sensor%u", &id) != 1 || id >= SENSORES_MAX)
+        return;
+    calib_sensor_t *c = &calib[id];
+    long v[3];
+    int n = ler_inteiros(valor, v, 3);
+
+    if (strcmp(chave, "giro_dps") == 0 && n == 1 && v[0] > 0 && v[0] <= 2000)
+        c->giro_dps = v[0];
+    else if (strcmp(chave, "giro_bias") == 0 && n == 3)
+    {
+        for (int i = 0; i < 3; i++)
+            c->giro_bias[i] = saturar(v[i]);
+        c->tem_giro = true;
+    }
+    else if (strcmp(chave, "acel_g") == 0 && n == 1 && v[0] > 0 && v[0] <= 16)
+        c->acel_g = v[0];
+    else if (strcmp(chave, "acel_offset") == 0 && n == 3)
+    {
+        for (int i = 0; i < 3; i++)
+            c->acel_offset[i] = saturar(v[i]);
+        c->tem_acel = true;
+    }
+    else if (strcmp(chave, "acel_ganho") == 0 && n == 3 && v[0] >= CALIB_GANHO_MIN && v[0] <= CALIB_GANHO_MAX &&
+             v[1] >= CALIB_GANHO_MIN && v[1] <= CALIB_GANHO_MAX && v[2] >= CALIB_GANHO_MIN && v[2] <= CALIB_GANHO_MAX)
+    {
+        for (int i = 0; i < 3; i++)
+            c->acel_ganho[i] = (int16_t)v[i];
+    }
+    else
+        printf("[CALIB] Valor inválido ignorado: %s = %s\n", chave, valor);
+}
+
+bool calibracao_carregar(void)
+{
+    calibracao_zerar();
+
+    if (config_ler_ini(CALIB_ARQUIVO, aplicar, NULL) != FR_OK)
+        return false;
+
+    // Sem o fundo de escala da medição os valores não podem ser convertidos
+    unsigned n = 0;
+    for (unsigned i = 0; i < SENSORES_MAX; i++)
+    {
+        calib_sensor_t *c = &calib[i];
+        c->tem_giro = c->tem_giro && c->giro_dps;
+        c->tem_acel = c->tem_acel && c->acel_g && c->acel_ganho[0];
+        n += c->tem_giro || c->tem_acel;
+    }
+    printf("[CALIB] %s: %u sensor(es) calibrado(s)\n", CALIB_ARQUIVO, n);
+    return true;
+}
+
+bool calibracao_salvar(void)
+{
+    FIL file;
+    FRESULT fr = f_open(&file, CALIB_ARQUIVO, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK)
+    {
+        printf("[CALIB] Falha ao gravar %s: %d\n", CALIB_ARQUIVO, fr);
+        return false;
+    }
+    f_printf(&file, "; Calibração dos sensores (gerada pelo comando calibrar)\n");
+    f_printf(&file, "; contagens brutas no fundo de escala indicado; ganho em Q2.14 (16384 = 1,0)\n");
+    for (unsigned i = 0; i < SENSORES_MAX; i++)
+    {
+        const calib_sensor_t *c = &calib[i];
+        if (!c->tem_giro && !c->tem_acel)
+            continue;
+        f_printf(&file, "[sensor%u]\n", i);
+        if (c->tem_giro)
+        {
+            f_printf(&file, "giro_dps = %u\n", c->giro_dps);
+            f_printf(&file, "giro_bias = %d %d %d\n", c->giro_bias[0], c->giro_bias[1], c->giro_bias[2]);
+        }
+        if (c->tem_acel)
+        {
+            f_printf(&file, "acel_g = %u\n", c->acel_g);
+            f_printf(&file, "acel_offset = %d %d %d\n", c->acel_offset[0], c->acel_offset[1], c->acel_offset[2]);
+            f_printf(&file, "acel_ganho = %d %d %d\n", c->acel_ganho[0], c->acel_ganho[1], c->acel_ganho[2]);
+        }
+    }
+    fr = f_close(&file);
+    return fr == FR_OK;
+}
+
+void calibracao_imprimir(void)
+{
+    bool alguma = false;
+    for (unsigned i = 0; i < SENSORES_MAX; i++)
+    {
+        const calib_sensor_t *c = &calib[i];
+        const posicoes_t *p = &posicoes[i];
+        if (c->tem_giro)
+            printf("[CALIB] %u: giro bias %d %d %d (+-%u dps)\n", i, c->giro_bias[0], c->giro_bias[1],
+                   c->giro_bias[2], c->giro_dps);
+        if (c->tem_acel)
+            printf("[CALIB] %u: acel offset %d %d %d, ganho %.4f %.4f %.4f (+-%u g)\n", i, c->acel_offset[0],
+                   c->acel_offset[1], c->acel_offset[2], c->acel_ganho[0] / (float)(1 << CALIB_Q),
+                   c->acel_ganho[1] / (float)(1 << CALIB_Q), c->acel_ganho[2] / (float)(1 << CALIB_Q), c->acel_g);
+        if (p->feitas)
+        {
+            printf("[CALIB] %u: posicoes do acelerometro medidas:", i);
+            for (int k = 0; k < CALIB_POSICOES; k++)
+                if (p->feitas & (1u << k))
+                    printf(" %s", nomes_posicao[k]);
+            printf("\n");
+        }
+        alguma = alguma || c->tem_giro || c->tem_acel || p->feitas;
+    }
+    if (!alguma)
+        printf("[CALIB] Nenhum sensor calibrado\n");
+}
@@ -0,0 +1,68 @@
+#ifndef CALIBRACAO_H
+#define CALIBRACAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor.h"
+
+// Calibração dos sensores, feita no próprio datalogger pelo comando
+// "calibrar" e guardada em CALIB_ARQUIVO no cartão:
+//  - giroscópio: média com o sensor parado (bias de cada eixo);
+//  - acelerômetro: seis posições, cada eixo apontando para cima (+1 g) e
+//    para baixo (-1 g); de cada par saem o offset e o ganho do eixo.
+//
+// A correção é inteira e roda na captura, antes da fila: toda amostra
+// gravada (CSV ou bruta) já sai corrigida. Os valores são guardados no
+// fundo de escala em que foram medidos e convertidos para o da captura.
+
+#define CALIB_ARQUIVO "calib.ini"
+#define CALIB_Q 14 // ganho do acelerômetro em ponto fixo Q2.14 (16384 = 1,0)
+
+// Posições da calibração do acelerômetro: o eixo indicado aponta para cima
+typedef enum
+{
+    CALIB_X_CIMA,
+    CALIB_X_BAIXO,
+    CALIB_Y_CIMA,
+    CALIB_Y_BAIXO,
+    CALIB_Z_CIMA,
+    CALIB_Z_BAIXO,
+    CALIB_POSICOES
+} calib_posicao_t;
+
+// Nome da posição no comando ("+x", "-x", ...) ou -1 se inválido
+int calibracao_posicao(const char *nome);
+
+// Lê CALIB_ARQUIVO do volume montado. Sem arquivo, nenhuma correção é aplicada.
+bool calibracao_carregar(void);
+
+// Grava a calibração atual em CALIB_ARQUIVO
+bool calibracao_salvar(void);
+
+// Descarta a calibração de todos os sensores (não apaga o arquivo)
+void calibracao_zerar(void);
+
+// Converte a calibração do sensor para o fundo de escala da captura. Chamada
+// depois de configurar o sensor, com a captura parada.
+void calibracao_preparar(const sensor_t *s);
+
+// Corrige uma leitura bruta do sensor 'id' (caminho quente da captura)
+void calibracao_aplicar(uint8_t id, sensor_leitura_t *l);
+
+// Coleta: enquanto ligada, a captura soma as leituras brutas de cada sensor
+void calibracao_coleta_iniciar(void);
+void calibracao_coleta_parar(void);
+void calibracao_acumular(uint8_t id, const sensor_leitura_t *l);
+
+// Calcula o bias do giroscópio com a última coleta. Falha se o sensor se
+// mexeu ou não houve leituras.
+bool calibracao_giro(const sensor_t *s);
+
+// Guarda a média do acelerômetro na posição pedida. Quando as seis posições
+// estiverem medidas, calcula offset e ganho e retorna true.
+bool calibracao_acel(const sensor_t *s, calib_posicao_t posicao);
+
+// Mostra a calibração e as posições do acelerômetro já medidas
+void calibracao_imprimir(void);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef CAMINHO_QUENTE_H
+#define CAMINHO_QUENTE_H
+
+#include "pico/stdlib.h"
+
+// CAPTURA_RAM = 1 (opção do CMake): o caminho quente da aquisição e do log
+// (vCapturaTask, leitura do MPU6050, formatação, staging, compressão LZ,
+// CRC e o driver SPI do cartão) é copiado para a SRAM no boot e não sofre
+// falhas do cache XIP da flash. Custa RAM; o comando "jitter" mede o efeito.
+// As funções do pico-sdk, do FreeRTOS e da newlib chamadas no caminho (I2C,
+// filas, snprintf) continuam na flash.
+#ifndef CAPTURA_RAM
+#define CAPTURA_RAM 0
+#endif
+
+#if CAPTURA_RAM
+#define CAMINHO_QUENTE(func) __not_in_flash_func(func)
+#define DADOS_QUENTES __not_in_flash("dados_quentes") // tabelas consultadas no caminho
+#else
+#define CAMINHO_QUENTE(func) func
+#define DADOS_QUENTES
+#endif
+
+#endif
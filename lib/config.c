@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "ff.h"
+#include "config.h"
+
+void config_padrao(config_t *cfg)
+{
+    cfg->taxa_hz = 10;
+    cfg->dlpf = 0;
+    cfg->acel_g = 2;
+    cfg->giro_dps = 250;
+    cfg->formato = FORMATO_CSV;
+    cfg->orientacao = false;
+    cfg->resumo_hz = 0;
+    cfg->gatilho = GATILHO_CONTINUO;
+    cfg->limiar_mg = 800;
+    cfg->limiar_dps = 200;
+    cfg->pre_ms = 1000;
+    cfg->pos_ms = 3000;
+}
+
+// Remove espaços do início e do fim (altera a string)
+static char *aparar(char *s)
+{
+    while (isspace((unsigned char)*s))
+        s++;
+    char *fim = s + strlen(s);
+    while (fim > s && isspace((unsigned char)fim[-1]))
+        *--fim = '\0';
+    return s;
+}
+
+// Fundos de escala aceitos no config.ini (os do MPU6050; cada driver usa o
+// mais próximo que suporta)
+static bool acel_valido(long g)
+{
+    return g == 2 || g == 4 || g == 8 || g == 16;
+}
+
+static bool giro_valido(long dps)
+{
+    return dps == 250 || dps == 500 || dps == 1000 || dps == 2000;
+}
+
+static const char *const nomes_gatilho[] = {"continuo", "acel", "giro", "movimento"};
+
+// Seções são ignoradas: as chaves do config.ini são únicas
+static void aplicar(void *ctx, const char *secao, const char *chave, const char *valor)
+{
+    config_t *cfg = ctx;
+    char *fim;
+    long n = strtol(valor, &fim, 10);
+    bool numero = (fim != valor && *fim == '\0');
+
+    if (strcmp(chave, "taxa_hz") == 0 && numero && n > 0 && n <= 8000)
+        cfg->taxa_hz = n;
+    else if (strcmp(chave, "dlpf") == 0 && numero && n >= 0 && n <= 6)
+        cfg->dlpf = n;
+    else if (strcmp(chave, "acel_g") == 0 && numero && acel_valido(n))
+        cfg->acel_g = n;
+    else if (strcmp(chave, "giro_dps") == 0 && numero && giro_valido(n))
+        cfg->giro_dps = n;
+    else if (strcmp(chave, "formato") == 0 && strcmp(valor, "csv") == 0)
+        cfg->formato = FORMATO_CSV;
+    else if (strcmp(chave, "formato") == 0 && strcmp(valor, "bruto") == 0)
+        cfg->formato = FORMATO_BRUTO;
+    else if (strcmp(chave, "orientacao") == 0 && numero && (n == 0 || n == 1))
+        cfg->orientacao = n;
+    else if (strcmp(chave, "resumo_hz") == 0 && numero && n >= 0 && n <= 1000)
+        cfg->resumo_hz = n;
+    else if (strcmp(chave, "modo") == 0 && config_gatilho(valor) >= 0)
+        cfg->gatilho = config_gatilho(valor);
+    else if (strcmp(chave, "limiar_mg") == 0 && numero && n > 0 && n <= 32000)
+        cfg->limiar_mg = n;
+    else if (strcmp(chave, "limiar_dps") == 0 && numero && n > 0 && n <= 4000)
+        cfg->limiar_dps = n;
+    else if (strcmp(chave, "pre_ms") == 0 && numero && n >= 0 && n <= 60000)
+        cfg->pre_ms = n;
+    else if (strcmp(chave, "pos_ms") == 0 && numero && n >= 0 && n <= 60000)
+        cfg->pos_ms = n;
+    else
+        printf("[CONFIG] Valor inválido ignorado: %s = %s\n", chave, valor);
+}
+
+// Cria o config.ini com os valores atuais, para servir de modelo
+static void config_criar(const config_t *cfg)
+{
+    FIL file;
+    if (f_open(&file, CONFIG_ARQUIVO, FA_WRITE | FA_CREATE_NEW) != FR_OK)
+        return;
+    f_printf(&file, "; Configuração do datalogger\n");
+    f_printf(&file, "[amostragem]\n");
+    f_printf(&file, "taxa_hz = %u\n", cfg->taxa_hz);
+    f_printf(&file, "; filtro passa-baixas, DLPF_CFG do MPU6050: 0 = 260 Hz ... 6 = 5 Hz\n");
+    f_printf(&file, "dlpf = %u\n", cfg->dlpf);
+    f_printf(&file, "[sensor]\n");
+    f_printf(&file, "; 2, 4, 8 ou 16\n");
+    f_printf(&file, "acel_g = %u\n", cfg->acel_g);
+    f_printf(&file, "; 250, 500, 1000 ou 2000\n");
+    f_printf(&file, "giro_dps = %u\n", cfg->giro_dps);
+    f_printf(&file, "[saida]\n");
+    f_printf(&file, "; csv (g e graus/s) ou bruto (contagens do sensor)\n");
+    f_printf(&file, "formato = %s\n", cfg->formato == FORMATO_BRUTO ? "bruto" : "csv");
+    f_printf(&file, "; 1 = colunas roll, pitch e yaw (graus; centésimos de grau no bruto)\n");
+    f_printf(&file, "orientacao = %u\n", cfg->orientacao);
+    f_printf(&file, "; resumo.csv com média, mínimo, máximo e RMS de cada eixo nesta taxa (0 = desligado)\n");
+    f_printf(&file, "resumo_hz = %u\n", cfg->resumo_hz);
+    f_printf(&file, "[gatilho]\n");
+    f_printf(&file, "; continuo, acel (|a| longe de 1 g), giro (|w|) ou movimento (interrupção do MPU6050)\n");
+    f_printf(&file, "modo = %s\n", nomes_gatilho[cfg->gatilho]);
+    f_printf(&file, "limiar_mg = %u\n", cfg->limiar_mg);
+    f_printf(&file, "limiar_dps = %u\n", cfg->limiar_dps);
+    f_printf(&file, "; janelas gravadas antes e depois de cada disparo\n");
+    f_printf(&file, "pre_ms = %u\n", cfg->pre_ms);
+    f_printf(&file, "pos_ms = %u\n", cfg->pos_ms);
+    f_close(&file);
+    printf("[CONFIG] %s criado com a configuração padrão.\n", CONFIG_ARQUIVO);
+}
+
+int config_gatilho(const char *nome)
+{
+    for (size_t i = 0; i < sizeof(nomes_gatilho) / sizeof(nomes_gatilho[0]); i++)
+        if (strcmp(nome, nomes_gatilho[i]) == 0)
+            return (int)i;
+    return -1;
+}
+
+const char *config_nome_gatilho(gatilho_modo_t modo)
+{
+    return nomes_gatilho[modo];
+}
+
+FRESULT config_ler_ini(const char *caminho, config_ini_valor_t valor, void *ctx)
+{
+    FIL file;
+    FRESULT fr = f_open(&file, caminho, FA_READ);
+    if (fr != FR_OK)
+        return fr;
+
+    char secao[24] = "";
+    char linha[80];
+    while (f_gets(linha, sizeof(linha), &file))
+    {
+        char *c = strpbrk(linha, ";#");
+        if (c)
+            *c = '\0';
+        char *s = aparar(linha);
+        if (*s == '[')
+        {
+            char *fim = strchr(s, ']');
+            if (fim)
+                *fim = '\0';
+            snprintf(secao, sizeof(secao), "%s", aparar(s + 1));
+            continue;
+        }
+
+        char *igual = strchr(s, '=');
+        if (igual == NULL)
+            continue;
+        *igual = '\0';
+        valor(ctx, secao, aparar(s), aparar(igual + 1));
+    }
+    f_close(&file);
+    return FR_OK;
+}
+
+bool config_carregar(config_t *cfg)
+{
+    FRESULT fr = config_ler_ini(CONFIG_ARQUIVO, aplicar, cfg);
+    if (fr == FR_NO_FILE)
+    {
+        config_criar(cfg);
+        return false;
+    }
+    if (fr != FR_OK)
+    {
+        printf("[CONFIG] Falha ao abrir %s: %d\n", CONFIG_ARQUIVO, fr);
+        return false;
+    }
+    return true;
+}
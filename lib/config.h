@@ -0,0 +1,66 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+// Nome do arquivo de configuração na raiz do cartão
+#define CONFIG_ARQUIVO "config.ini"
+
+// Formato das linhas gravadas no log
+typedef enum
+{
+    FORMATO_CSV,  // valores convertidos (g e °/s) com 2 casas decimais
+    FORMATO_BRUTO // leituras brutas do sensor (contagens int16)
+} formato_saida_t;
+
+// O que dispara a gravação de um evento (seção [gatilho])
+typedef enum
+{
+    GATILHO_CONTINUO,  // sem gatilho: grava tudo
+    GATILHO_ACEL,      // |a| se afasta de 1 g mais que limiar_mg (impacto ou queda livre)
+    GATILHO_GIRO,      // |ω| passa de limiar_dps
+    GATILHO_MOVIMENTO  // interrupção de movimento do MPU6050 (limiar_mg até 510)
+} gatilho_modo_t;
+
+// Configuração da captura lida do config.ini
+typedef struct
+{
+    uint16_t taxa_hz;  // taxa de amostragem
+    uint8_t dlpf;      // filtro passa-baixas (0..6, DLPF_CFG no MPU6050)
+    uint8_t acel_g;    // fundo de escala do acelerômetro em g
+    uint16_t giro_dps; // fundo de escala do giroscópio em °/s
+    formato_saida_t formato;
+    bool orientacao;   // colunas roll, pitch e yaw (lib/orientacao.h)
+    uint16_t resumo_hz; // taxa do resumo decimado em resumo.csv (0 = desligado)
+    gatilho_modo_t gatilho;
+    uint16_t limiar_mg;  // limiar dos modos acel e movimento
+    uint16_t limiar_dps; // limiar do modo giro
+    uint16_t pre_ms;     // janela gravada antes do disparo
+    uint16_t pos_ms;     // janela gravada depois do último disparo
+} config_t;
+
+// Preenche a configuração padrão (10 Hz, ±2 g, ±250 °/s, sem DLPF, CSV, sem
+// orientação nem resumo, gravação contínua)
+void config_padrao(config_t *cfg);
+
+// Lê o config.ini do cartão montado. Campos ausentes ou inválidos mantêm o
+// valor atual. Se o arquivo não existir, ele é criado com os valores atuais.
+bool config_carregar(config_t *cfg);
+
+// Chamada por config_ler_ini a cada "chave = valor", com o nome da seção
+// corrente sem colchetes ("" antes da primeira) e os textos já aparados
+typedef void (*config_ini_valor_t)(void *ctx, const char *secao, const char *chave, const char *valor);
+
+// Lê um arquivo .ini do cartão montado (config.ini, calib.ini): ignora
+// comentários (';' ou '#') e linhas sem '='. Retorna o resultado do f_open.
+FRESULT config_ler_ini(const char *caminho, config_ini_valor_t valor, void *ctx);
+
+// Modo do gatilho pelo nome do config.ini, ou -1 se desconhecido
+int config_gatilho(const char *nome);
+
+// Nome do modo do gatilho no config.ini
+const char *config_nome_gatilho(gatilho_modo_t modo);
+
+#endif
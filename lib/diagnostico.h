@@ -0,0 +1,26 @@
+#ifndef DIAGNOSTICO_H
+#define DIAGNOSTICO_H
+
+#include <stdint.h>
+
+// Contadores de desempenho mantidos pela captura e pela gravação
+// (Datalogger.c), lidos pela tela de diagnóstico, pelos benchmarks e pela
+// conferência do simulador
+typedef struct
+{
+    volatile uint32_t amostras_lidas;    // leituras dos sensores (um registro por sensor)
+    volatile uint32_t registros_gravados; // registros acrescentados ao log
+    volatile uint32_t amostras_perdidas; // amostras descartadas com a fila cheia
+    volatile uint32_t periodos_atrasados; // períodos em que a leitura não terminou no prazo
+    volatile uint32_t leituras_falhas;   // leituras sem resposta do sensor (registro repete a anterior)
+    volatile uint32_t fila_max;          // maior ocupação observada da fila de amostras
+    volatile uint32_t bytes_gravados;    // bytes entregues ao cartão
+    volatile uint32_t lat_ultima_us;     // duração da última gravação de bloco
+    volatile uint32_t lat_max_us;        // pior gravação de bloco
+    volatile uint32_t tempo_captura_us;  // tempo ocupado da captura (leitura e envio)
+    volatile uint32_t tempo_gravacao_us; // tempo ocupado da gravação (formatação e SD)
+} diagnostico_t;
+
+extern diagnostico_t diag;
+
+#endif
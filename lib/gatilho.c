@@ -0,0 +1,56 @@
+#include "gatilho.h"
+#include "sensores.h"
+#include "caminho_quente.h"
+
+// Limiares de cada sensor em LSB²
+typedef struct
+{
+    gatilho_modo_t modo;
+    uint32_t acel_min; // |a|² abaixo disso dispara (queda livre); 0 = nunca
+    uint32_t acel_max; // |a|² acima disso dispara (impacto)
+    uint32_t giro_max; // |ω|² acima disso dispara
+} limiares_t;
+
+static limiares_t limiares[SENSORES_MAX];
+
+// Quadrado de um módulo em LSB, saturado no maior |v|² possível com int16
+static uint32_t quadrado(float lsb)
+{
+    float q = lsb * lsb;
+    return q >= 4294967295.0f ? UINT32_MAX : (uint32_t)q;
+}
+
+void gatilho_preparar(uint8_t id, const config_t *cfg, float escala_acel, float escala_giro)
+{
+    limiares_t *l = &limiares[id];
+    l->modo = cfg->gatilho;
+
+    float limiar_g = cfg->limiar_mg / 1000.0f;
+    l->acel_max = quadrado((1.0f + limiar_g) * escala_acel);
+    l->acel_min = limiar_g < 1.0f ? quadrado((1.0f - limiar_g) * escala_acel) : 0;
+    l->giro_max = quadrado(cfg->limiar_dps * escala_giro);
+}
+
+bool CAMINHO_QUENTE(gatilho_testar)(uint8_t id, const sensor_leitura_t *l, bool movimento)
+{
+    const limiares_t *lim = &limiares[id];
+    switch (lim->modo)
+    {
+    case GATILHO_ACEL:
+    {
+        int32_t x = l->acel[0], y = l->acel[1], z = l->acel[2];
+        uint32_t norma = (uint32_t)(x * x) + (uint32_t)(y * y) + (uint32_t)(z * z);
+        return norma > lim->acel_max || norma < lim->acel_min;
+    }
+    case GATILHO_GIRO:
+    {
+        int32_t x = l->giro[0], y = l->giro[1], z = l->giro[2];
+        uint32_t norma = (uint32_t)(x * x) + (uint32_t)(y * y) + (uint32_t)(z * z);
+        return norma > lim->giro_max;
+    }
+    case GATILHO_MOVIMENTO:
+        return movimento;
+    default:
+        return true;
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef GATILHO_H
+#define GATILHO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "sensor.h"
+
+// Teste do gatilho de evento (seção [gatilho] do config.ini), feito leitura
+// a leitura pela gravação. Os limiares são convertidos uma vez para LSB² do
+// fundo de escala de cada sensor: o teste compara o quadrado do módulo, só
+// com multiplicações inteiras, sem raiz nem float.
+
+// Converte os limiares da configuração para a escala do sensor id (LSB/g e
+// LSB/(°/s)). Chamar no início de cada captura.
+void gatilho_preparar(uint8_t id, const config_t *cfg, float escala_acel, float escala_giro);
+
+// true se a leitura dispara o evento. movimento é a interrupção de
+// movimento do próprio sensor (modo "movimento").
+bool gatilho_testar(uint8_t id, const sensor_leitura_t *l, bool movimento);
+
+#endif
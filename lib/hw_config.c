@@ -9,6 +9,8 @@
 #include "ff.h" /* Obtains integer types */
 //
 #include "diskio.h" /* Declarations of disk functions */
+//
+#include "arena.h"
 
 /* 
 This example assumes the following hardware configuration:
@@ -41,7 +43,9 @@ static spi_t spis[] = {  // One for each SPI.
     }};
 
 // Hardware Configuration of the SD Card "objects"
-static sd_card_t sd_cards[] = {  // One for each SD card
+// No SRAM4: a janela de setor do FATFS (FAT e diretório) é lida e escrita
+// pelo DMA do SPI sem disputar a SRAM intercalada com o núcleo 0
+static sd_card_t sd_cards[] ARENA_SRAM4 = {  // One for each SD card
     {
         .pcName = "0:",   // Name used to mount device
         .spi = &spis[0],  // Pointer to the SPI driving this card
@@ -0,0 +1,265 @@
+#include <string.h>
+#include "lzblock.h"
+#include "crc.h"
+#include "caminho_quente.h"
+
+// Tabela de hash com 2^10 posições de 16 bits (2 KB): suficiente para blocos
+// de até 64 KB e pequena o bastante para a SRAM do RP2040.
+#define LZB_HASH_LOG 10
+#define LZB_MIN_MATCH 4
+#define LZB_LAST_LITERALS 5 // o formato LZ4 exige os últimos 5 bytes como literais
+#define LZB_MFLIMIT 12      // último match precisa começar 12 bytes antes do fim
+
+static uint16_t tabela_hash[1 << LZB_HASH_LOG];
+
+static inline uint32_t ler32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t hash4(uint32_t v)
+{
+    return (v * 2654435761u) >> (32 - LZB_HASH_LOG);
+}
+
+static inline void escrever16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static inline uint16_t ler16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Escreve o comprimento estendido (bytes 255... + resto) usado pelo LZ4
+static uint8_t *CAMINHO_QUENTE(escrever_extensao)(uint8_t *op, size_t n)
+{
+    while (n >= 255)
+    {
+        *op++ = 255;
+        n -= 255;
+    }
+    *op++ = (uint8_t)n;
+    return op;
+}
+
+// Emite uma sequência: token, literais e (se houver) offset + comprimento do match
+static uint8_t *CAMINHO_QUENTE(emitir_sequencia)(uint8_t *op, const uint8_t *oend, const uint8_t *literais,
+                                                 size_t n_lit, uint16_t offset, size_t n_match, bool tem_match)
+{
+    // Pior caso: token + extensões + literais + offset
+    size_t necessario = 1 + n_lit + (n_lit / 255 + 1) + (tem_match ? 2 + n_match / 255 + 1 : 0);
+    if ((size_t)(oend - op) < necessario)
+        return NULL;
+
+    uint8_t *token = op++;
+    *token = (uint8_t)((n_lit >= 15 ? 15 : n_lit) << 4);
+    if (n_lit >= 15)
+        op = escrever_extensao(op, n_lit - 15);
+    memcpy(op, literais, n_lit);
+    op += n_lit;
+
+    if (tem_match)
+    {
+        escrever16(op, offset);
+        op += 2;
+        *token |= (uint8_t)(n_match >= 15 ? 15 : n_match);
+        if (n_match >= 15)
+            op = escrever_extensao(op, n_match - 15);
+    }
+    return op;
+}
+
+size_t CAMINHO_QUENTE(lzb_compress)(const uint8_t *src, size_t len, uint8_t *dst, size_t cap)
+{
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *const iend = src + len;
+    uint8_t *op = dst;
+    const uint8_t *const oend = dst + cap;
+
+    if (len > 0xFFFF)
+        return 0;
+
+    if (len > LZB_MFLIMIT)
+    {
+        const uint8_t *const mflimit = iend - LZB_MFLIMIT;
+        const uint8_t *const matchlimit = iend - LZB_LAST_LITERALS;
+
+        memset(tabela_hash, 0, sizeof(tabela_hash));
+        while (ip < mflimit)
+        {
+            uint32_t seq = ler32(ip);
+            uint32_t h = hash4(seq);
+            const uint8_t *ref = src + tabela_hash[h];
+            tabela_hash[h] = (uint16_t)(ip - src);
+
+            if (ref >= ip || ler32(ref) != seq)
+            {
+                ip++;
+                continue;
+            }
+
+            // Estende o match para trás enquanto houver literais pendentes
+            while (ip > anchor && ref > src && ip[-1] == ref[-1])
+            {
+                ip--;
+                ref--;
+            }
+
+            // Estende o match para frente
+            const uint8_t *mp = ip + LZB_MIN_MATCH;
+            const uint8_t *rp = ref + LZB_MIN_MATCH;
+            while (mp < matchlimit && *mp == *rp)
+            {
+                mp++;
+                rp++;
+            }
+
+            op = emitir_sequencia(op, oend, anchor, ip - anchor, (uint16_t)(ip - ref),
+                                  mp - ip - LZB_MIN_MATCH, true);
+            if (op == NULL)
+                return 0;
+
+            ip = mp;
+            anchor = ip;
+        }
+    }
+
+    // Literais finais
+    op = emitir_sequencia(op, oend, anchor, iend - anchor, 0, 0, false);
+    if (op == NULL)
+        return 0;
+    return op - dst;
+}
+
+int lzb_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap)
+{
+    const uint8_t *ip = src;
+    const uint8_t *const iend = src + len;
+    uint8_t *op = dst;
+    uint8_t *const oend = dst + cap;
+
+    while (ip < iend)
+    {
+        uint8_t token = *ip++;
+
+        // Literais
+        size_t n = token >> 4;
+        if (n == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if (ip >= iend)
+                    return -1;
+                b = *ip++;
+                n += b;
+            } while (b == 255);
+        }
+        if ((size_t)(iend - ip) < n || (size_t)(oend - op) < n)
+            return -1;
+        memcpy(op, ip, n);
+        ip += n;
+        op += n;
+
+        if (ip >= iend)
+            break; // última sequência não tem match
+
+        // Match
+        if (iend - ip < 2)
+            return -1;
+        uint16_t offset = ler16(ip);
+        ip += 2;
+        if (offset == 0 || offset > op - dst)
+            return -1;
+
+        n = token & 0x0F;
+        if (n == 15)
+        {
+            uint8_t b;
+            do
+            {
+                if (ip >= iend)
+                    return -1;
+                b = *ip++;
+                n += b;
+            } while (b == 255);
+        }
+        n += LZB_MIN_MATCH;
+        if ((size_t)(oend - op) < n)
+            return -1;
+
+        // Cópia byte a byte: o match pode sobrepor a própria saída
+        const uint8_t *ref = op - offset;
+        while (n--)
+            *op++ = *ref++;
+    }
+    return op - dst;
+}
+
+size_t CAMINHO_QUENTE(lzb_encode_block)(const uint8_t *raw, uint16_t raw_len, uint8_t *out, size_t cap)
+{
+    if (cap < LZB_BOUND(raw_len))
+        return 0;
+
+    uint8_t *payload = out + LZB_HEADER_SIZE;
+    uint8_t flags = 0;
+
+    // Só vale a pena comprimir se o resultado for menor que o bloco original
+    size_t payload_len = lzb_compress(raw, raw_len, payload, raw_len);
+    if (payload_len == 0 || payload_len >= raw_len)
+    {
+        memcpy(payload, raw, raw_len);
+        payload_len = raw_len;
+        flags |= LZB_FLAG_RAW;
+    }
+
+    memcpy(out, LZB_MAGIC, 4);
+    escrever16(out + 4, raw_len);
+    escrever16(out + 6, (uint16_t)payload_len);
+    escrever16(out + 8, crc16((const char *)raw, raw_len));
+    out[10] = flags;
+    out[11] = 0;
+    return LZB_HEADER_SIZE + payload_len;
+}
+
+bool lzb_parse_header(const uint8_t *hdr, uint16_t *raw_len, uint16_t *payload_len, uint16_t *crc, uint8_t *flags)
+{
+    if (memcmp(hdr, LZB_MAGIC, 4) != 0)
+        return false;
+    *raw_len = ler16(hdr + 4);
+    *payload_len = ler16(hdr + 6);
+    *crc = ler16(hdr + 8);
+    *flags = hdr[10];
+    return true;
+}
+
+int lzb_decode_block(const uint8_t *in, size_t in_len, uint8_t *out, size_t cap)
+{
+    uint16_t raw_len, payload_len, crc;
+    uint8_t flags;
+
+    if (in_len < LZB_HEADER_SIZE || !lzb_parse_header(in, &raw_len, &payload_len, &crc, &flags))
+        return -1;
+    if (in_len < (size_t)LZB_HEADER_SIZE + payload_len || cap < raw_len)
+        return -1;
+
+    const uint8_t *payload = in + LZB_HEADER_SIZE;
+    int n;
+    if (flags & LZB_FLAG_RAW)
+    {
+        memcpy(out, payload, payload_len);
+        n = payload_len;
+    }
+    else
+    {
+        n = lzb_decompress(payload, payload_len, out, cap);
+    }
+
+    if (n != raw_len || crc16((const char *)out, n) != crc)
+        return -1;
+    return n;
+}
@@ -0,0 +1,46 @@
+#ifndef LZBLOCK_H
+#define LZBLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Compressor LZ da família LZ4 (formato de bloco LZ4) para os blocos de log.
+// Cada bloco gravado no cartão tem um cabeçalho próprio, de modo que o
+// programa no PC consegue descomprimir os blocos de forma independente
+// (e em paralelo).
+//
+// Cabeçalho (12 bytes, little-endian):
+//   [0..3]   magic "LZB1"
+//   [4..5]   tamanho original (bytes)
+//   [6..7]   tamanho do payload gravado (bytes)
+//   [8..9]   CRC16-CCITT (XMODEM) dos dados originais
+//   [10]     flags (LZB_FLAG_RAW: payload armazenado sem compressão)
+//   [11]     reservado
+
+#define LZB_MAGIC "LZB1"
+#define LZB_HEADER_SIZE 12
+#define LZB_FLAG_RAW 0x01
+
+// Tamanho de saída que sempre comporta um bloco de 'raw_len' bytes
+#define LZB_BOUND(raw_len) ((size_t)LZB_HEADER_SIZE + (raw_len))
+
+// Comprime 'len' bytes no formato de bloco LZ4. Retorna o tamanho gerado
+// ou 0 se a saída não couber em 'cap' bytes.
+size_t lzb_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap);
+
+// Descomprime um bloco LZ4. Retorna o tamanho gerado ou -1 se o bloco for inválido.
+int lzb_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap);
+
+// Monta cabeçalho + payload (comprimido, ou cru se não compensar).
+// Retorna o total de bytes escritos em 'out' ou 0 em caso de erro.
+size_t lzb_encode_block(const uint8_t *raw, uint16_t raw_len, uint8_t *out, size_t cap);
+
+// Lê o cabeçalho de um bloco. Retorna false se o magic não conferir.
+bool lzb_parse_header(const uint8_t *hdr, uint16_t *raw_len, uint16_t *payload_len, uint16_t *crc, uint8_t *flags);
+
+// Decodifica um bloco completo (cabeçalho + payload) e confere o CRC.
+// Retorna o tamanho original ou -1 em caso de erro.
+int lzb_decode_block(const uint8_t *in, size_t in_len, uint8_t *out, size_t cap);
+
+#endif
@@ -1,4 +1,5 @@
 #include "mpu6050.h"
+#include "caminho_quente.h"
 
 void mpu6050_init(i2c_inst_t *i2c, uint8_t addr)
 {
@@ -21,23 +22,107 @@ void mpu6050_reset(i2c_inst_t *i2c, uint8_t addr)
     sleep_ms(10);
 }
 
-void mpu6050_read_raw(i2c_inst_t *i2c, uint8_t addr, int16_t accel[3], int16_t gyro[3], int16_t *temp)
+// Os 14 registradores de dados são contíguos: um endereçamento e uma leitura
+// por amostra, em vez de uma transação por grupo. Com int_status, a leitura
+// começa no INT_STATUS, logo antes dos dados.
+static bool CAMINHO_QUENTE(ler_rajada)(i2c_inst_t *i2c, uint8_t addr, int16_t accel[3], int16_t gyro[3], int16_t *temp,
+                                       uint8_t *int_status)
 {
-    uint8_t buffer[6];
-    uint8_t val = 0x3B;
-    i2c_write_blocking(i2c, addr, &val, 1, true);
-    i2c_read_blocking(i2c, addr, buffer, 6, false);
-    for (int i = 0; i < 3; i++)
-        accel[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
+    uint8_t buffer[MPU6050_RAJADA_TAM + 1];
+    uint8_t val = int_status ? MPU6050_REG_INT_STATUS : MPU6050_REG_ACCEL_XOUT_H;
+    size_t tam = int_status ? MPU6050_RAJADA_TAM + 1 : MPU6050_RAJADA_TAM;
+    if (i2c_write_blocking(i2c, addr, &val, 1, true) != 1 || i2c_read_blocking(i2c, addr, buffer, tam, false) != (int)tam)
+        return false;
 
-    val = 0x43;
-    i2c_write_blocking(i2c, addr, &val, 1, true);
-    i2c_read_blocking(i2c, addr, buffer, 6, false);
+    const uint8_t *dados = buffer;
+    if (int_status)
+        *int_status = *dados++;
     for (int i = 0; i < 3; i++)
-        gyro[i] = (buffer[i * 2] << 8) | buffer[(i * 2) + 1];
+    {
+        accel[i] = (dados[i * 2] << 8) | dados[(i * 2) + 1];
+        gyro[i] = (dados[8 + i * 2] << 8) | dados[8 + (i * 2) + 1];
+    }
+    *temp = (dados[6] << 8) | dados[7];
+    return true;
+}
+
+bool CAMINHO_QUENTE(mpu6050_read_raw)(i2c_inst_t *i2c, uint8_t addr, int16_t accel[3], int16_t gyro[3], int16_t *temp)
+{
+    return ler_rajada(i2c, addr, accel, gyro, temp, NULL);
+}
+
+bool CAMINHO_QUENTE(mpu6050_read_raw_status)(i2c_inst_t *i2c, uint8_t addr, int16_t accel[3], int16_t gyro[3],
+                                             int16_t *temp, uint8_t *int_status)
+{
+    return ler_rajada(i2c, addr, accel, gyro, temp, int_status);
+}
+
+int mpu6050_who_am_i(i2c_inst_t *i2c, uint8_t addr)
+{
+    uint8_t val = MPU6050_REG_WHO_AM_I;
+    if (i2c_write_blocking(i2c, addr, &val, 1, true) != 1 || i2c_read_blocking(i2c, addr, &val, 1, false) != 1)
+        return -1;
+    return val;
+}
+
+static void mpu6050_write_reg(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, uint8_t value)
+{
+    uint8_t buf[] = {reg, value};
+    i2c_write_blocking(i2c, addr, buf, 2, false);
+}
 
-    val = 0x41;
-    i2c_write_blocking(i2c, addr, &val, 1, true);
-    i2c_read_blocking(i2c, addr, buffer, 2, false);
-    *temp = (buffer[0] << 8) | buffer[1];
+uint16_t mpu6050_configure(i2c_inst_t *i2c, uint8_t addr, mpu6050_accel_range_t accel_range,
+                           mpu6050_gyro_range_t gyro_range, uint8_t dlpf, uint16_t rate_hz)
+{
+    if (dlpf > 6)
+        dlpf = 6;
+    mpu6050_write_reg(i2c, addr, MPU6050_REG_CONFIG, dlpf);
+    mpu6050_write_reg(i2c, addr, MPU6050_REG_GYRO_CONFIG, gyro_range << 3);
+    mpu6050_write_reg(i2c, addr, MPU6050_REG_ACCEL_CONFIG, accel_range << 3);
+
+    // Taxa = saída do giroscópio / (1 + SMPLRT_DIV); a saída é 8 kHz só sem DLPF
+    uint16_t base = (dlpf == 0) ? 8000 : 1000;
+    if (rate_hz == 0 || rate_hz > base)
+        rate_hz = base;
+    uint16_t div = base / rate_hz - 1;
+    if (div > 255)
+        div = 255;
+    mpu6050_write_reg(i2c, addr, MPU6050_REG_SMPLRT_DIV, div);
+    return base / (div + 1);
+}
+
+static uint8_t mpu6050_read_reg(i2c_inst_t *i2c, uint8_t addr, uint8_t reg)
+{
+    uint8_t val = 0;
+    if (i2c_write_blocking(i2c, addr, &reg, 1, true) == 1)
+        i2c_read_blocking(i2c, addr, &val, 1, false);
+    return val;
+}
+
+uint16_t mpu6050_configure_motion(i2c_inst_t *i2c, uint8_t addr, uint16_t threshold_mg)
+{
+    uint16_t thr = (threshold_mg + 1) / 2;
+    if (thr > 255)
+        thr = 255;
+    if (threshold_mg > 0 && thr == 0)
+        thr = 1;
+
+    // ACCEL_HPF (bits 2:0 do ACCEL_CONFIG): 1 = passa-altas de 5 Hz para a detecção
+    uint8_t accel_config = mpu6050_read_reg(i2c, addr, MPU6050_REG_ACCEL_CONFIG) & ~0x07;
+    mpu6050_write_reg(i2c, addr, MPU6050_REG_ACCEL_CONFIG, accel_config | (thr ? 1 : 0));
+    mpu6050_write_reg(i2c, addr, MPU6050_REG_MOT_THR, thr);
+    mpu6050_write_reg(i2c, addr, MPU6050_REG_MOT_DUR, 1);
+    mpu6050_write_reg(i2c, addr, MPU6050_REG_INT_ENABLE, thr ? MPU6050_INT_MOT : 0);
+    return thr * 2;
+}
+
+float mpu6050_accel_scale(mpu6050_accel_range_t range)
+{
+    return 16384.0f / (1 << range); // 16384, 8192, 4096, 2048 LSB/g
+}
+
+float mpu6050_gyro_scale(mpu6050_gyro_range_t range)
+{
+    static const float escala[] = {131.0f, 65.5f, 32.8f, 16.4f};
+    return escala[range & 3];
 }
@@ -4,8 +4,49 @@
 #include "hardware/i2c.h"
 #include "pico/stdlib.h"
 
-// Endereço padrão do MPU6050
+// Endereço padrão do MPU6050 e o alternativo (pino AD0 em nível alto)
 #define MPU6050_DEFAULT_ADDR 0x68
+#define MPU6050_ALT_ADDR 0x69
+
+// Valor do WHO_AM_I (o mesmo nos dois endereços) e o de clones comuns
+#define MPU6050_WHO_AM_I_ID 0x68
+#define MPU6050_WHO_AM_I_CLONE 0x72
+
+// Registradores de configuração
+#define MPU6050_REG_SMPLRT_DIV 0x19
+#define MPU6050_REG_CONFIG 0x1A
+#define MPU6050_REG_GYRO_CONFIG 0x1B
+#define MPU6050_REG_ACCEL_CONFIG 0x1C
+#define MPU6050_REG_MOT_THR 0x1F
+#define MPU6050_REG_MOT_DUR 0x20
+#define MPU6050_REG_INT_ENABLE 0x38
+#define MPU6050_REG_INT_STATUS 0x3A
+#define MPU6050_REG_ACCEL_XOUT_H 0x3B
+#define MPU6050_REG_WHO_AM_I 0x75
+
+// Leitura em rajada de ACCEL_XOUT_H a GYRO_ZOUT_L: acelerômetro, temperatura e giroscópio
+#define MPU6050_RAJADA_TAM 14
+
+// Bit MOT_INT (INT_ENABLE e INT_STATUS): interrupção de detecção de movimento
+#define MPU6050_INT_MOT (1 << 6)
+
+// Fundo de escala do acelerômetro (campo AFS_SEL)
+typedef enum
+{
+    MPU6050_ACCEL_2G = 0,
+    MPU6050_ACCEL_4G = 1,
+    MPU6050_ACCEL_8G = 2,
+    MPU6050_ACCEL_16G = 3
+} mpu6050_accel_range_t;
+
+// Fundo de escala do giroscópio (campo FS_SEL)
+typedef enum
+{
+    MPU6050_GYRO_250 = 0,
+    MPU6050_GYRO_500 = 1,
+    MPU6050_GYRO_1000 = 2,
+    MPU6050_GYRO_2000 = 3
+} mpu6050_gyro_range_t;
 
 // Inicializa o MPU6050 (reset e wake)
 void mpu6050_init(i2c_inst_t *i2c, uint8_t addr);
@@ -13,7 +54,33 @@ void mpu6050_init(i2c_inst_t *i2c, uint8_t addr);
 // Reseta o MPU6050
 void mpu6050_reset(i2c_inst_t *i2c, uint8_t addr);
 
-// Lê os dados brutos do acelerômetro, giroscópio e temperatura
-void mpu6050_read_raw(i2c_inst_t *i2c, uint8_t addr, int16_t accel[3], int16_t gyro[3], int16_t *temp);
+// Lê os dados brutos do acelerômetro, giroscópio e temperatura em uma única
+// transação. Retorna false se o sensor não respondeu.
+bool mpu6050_read_raw(i2c_inst_t *i2c, uint8_t addr, int16_t accel[3], int16_t gyro[3], int16_t *temp);
+
+// Como mpu6050_read_raw, começando um registrador antes: a mesma transação
+// traz o INT_STATUS (lido, ele é zerado pelo sensor)
+bool mpu6050_read_raw_status(i2c_inst_t *i2c, uint8_t addr, int16_t accel[3], int16_t gyro[3], int16_t *temp,
+                             uint8_t *int_status);
+
+// Lê o WHO_AM_I; retorna -1 se nenhum dispositivo responder no endereço
+int mpu6050_who_am_i(i2c_inst_t *i2c, uint8_t addr);
+
+// Configura fundo de escala, filtro passa-baixas (DLPF_CFG 0..6) e taxa de
+// amostragem em Hz. Retorna a taxa real obtida com o divisor inteiro.
+uint16_t mpu6050_configure(i2c_inst_t *i2c, uint8_t addr, mpu6050_accel_range_t accel_range,
+                           mpu6050_gyro_range_t gyro_range, uint8_t dlpf, uint16_t rate_hz);
+
+// Detecção de movimento do próprio sensor: MOT_INT sobe quando a aceleração
+// filtrada pelo passa-altas (5 Hz) passa do limiar em algum eixo por 1 ms.
+// Limiar em mg (2 mg/LSB, até 510 mg); 0 desliga. Chamar depois de
+// mpu6050_configure, que reescreve ACCEL_CONFIG. Retorna o limiar aplicado.
+uint16_t mpu6050_configure_motion(i2c_inst_t *i2c, uint8_t addr, uint16_t threshold_mg);
+
+// Sensibilidade em LSB/g para o fundo de escala do acelerômetro
+float mpu6050_accel_scale(mpu6050_accel_range_t range);
+
+// Sensibilidade em LSB/(°/s) para o fundo de escala do giroscópio
+float mpu6050_gyro_scale(mpu6050_gyro_range_t range);
 
 #endif
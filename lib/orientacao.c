@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "orientacao.h"
+#include "caminho_quente.h"
+
+#define CORDIC_ITERACOES 16
+#define CORDIC_ESCALA (1 << 14)    // entrada int16 ampliada para a precisão do CORDIC
+#define CORDIC_INV_K_Q16 39797     // 1/K = 0,607253 (ganho das iterações) em Q16
+#define CORDIC_INV_K_Q30 652032874 // idem em Q30
+#define BAM_90 0x40000000
+#define COS_MIN 1638 // cos(pitch) mínimo (0,05 em Q15, pitch de ~87°)
+
+// atan(2^-i) em BAM
+static const uint32_t atan_bam[CORDIC_ITERACOES] DADOS_QUENTES = {
+    0x20000000, 0x12e4051e, 0x09fb385b, 0x051111d4, 0x028b0d43, 0x0145d7e1, 0x00a2f61e, 0x00517c55,
+    0x0028be53, 0x00145f2f, 0x000a2f98, 0x000517cc, 0x00028be6, 0x000145f3, 0x0000a2fa, 0x0000517d,
+};
+
+// atan2(y, x) em BAM; em *modulo, K vezes o módulo de (x, y)
+static uint32_t CAMINHO_QUENTE(cordic_vetorizar)(int32_t x, int32_t y, int32_t *modulo)
+{
+    uint32_t angulo = 0;
+    if (x < 0)
+    {
+        x = -x;
+        y = -y;
+        angulo = 2u * BAM_90;
+    }
+    for (int i = 0; i < CORDIC_ITERACOES; i++)
+    {
+        int32_t dx = x >> i, dy = y >> i;
+        if (y > 0)
+        {
+            x += dy;
+            y -= dx;
+            angulo += atan_bam[i];
+        }
+        else
+        {
+            x -= dy;
+            y += dx;
+            angulo -= atan_bam[i];
+        }
+    }
+    *modulo = x;
+    return angulo;
+}
+
+// Seno e cosseno (Q15) de um ângulo em BAM
+static void CAMINHO_QUENTE(cordic_sen_cos)(uint32_t angulo, int32_t *sen, int32_t *cos)
+{
+    // O CORDIC converge até ~99°: o resto da volta é rebatido em 180°
+    int32_t z = (int32_t)angulo;
+    bool rebatido = z > BAM_90 || z < -BAM_90;
+    if (rebatido)
+        z = (int32_t)(angulo + 2u * BAM_90);
+
+    int32_t x = CORDIC_INV_K_Q30, y = 0;
+    for (int i = 0; i < CORDIC_ITERACOES; i++)
+    {
+        int32_t dx = x >> i, dy = y >> i;
+        if (z >= 0)
+        {
+            x -= dy;
+            y += dx;
+            z -= (int32_t)atan_bam[i];
+        }
+        else
+        {
+            x += dy;
+            y -= dx;
+            z += (int32_t)atan_bam[i];
+        }
+    }
+    *sen = rebatido ? -(y >> 15) : y >> 15;
+    *cos = rebatido ? -(x >> 15) : x >> 15;
+}
+
+// BAM para centésimos de grau
+static inline int16_t centigraus(uint32_t angulo)
+{
+    return (int16_t)(((int32_t)(int16_t)(angulo >> 16) * 36000 + 32768) >> 16);
+}
+
+void orientacao_iniciar(orientacao_t *o, float escala_acel, float escala_giro, uint16_t taxa_hz)
+{
+    if (taxa_hz == 0)
+        taxa_hz = 1;
+    o->k_giro = (int32_t)(1099511627776.0f / (360.0f * escala_giro * taxa_hz)); // 2^40 / (360 * LSB/(°/s) * Hz)
+    o->norma_min = (uint32_t)(0.25f * escala_acel * escala_acel); // 0,5 g
+    o->norma_max = (uint32_t)(2.25f * escala_acel * escala_acel); // 1,5 g
+
+    // Correção de 2^-d por amostra: constante de tempo de 2^d amostras
+    uint32_t amostras_tau = (uint32_t)taxa_hz * ORIENTACAO_TAU_MS / 1000;
+    o->deslocamento = 0;
+    while ((2u << o->deslocamento) <= amostras_tau)
+        o->deslocamento++;
+    o->iniciado = false;
+}
+
+void CAMINHO_QUENTE(orientacao_atualizar)(orientacao_t *o, const sensor_leitura_t *l, int16_t angulos[3])
+{
+    int32_t ax = l->acel[0], ay = l->acel[1], az = l->acel[2];
+
+    // Gravidade: roll = atan2(ay, az), pitch = atan2(-ax, |(ay, az)|)
+    int32_t modulo;
+    uint32_t roll_acel = cordic_vetorizar(az * CORDIC_ESCALA, ay * CORDIC_ESCALA, &modulo);
+    int32_t yz = (int32_t)(((int64_t)modulo * CORDIC_INV_K_Q16) >> 16);
+    uint32_t pitch_acel = cordic_vetorizar(yz, -ax * CORDIC_ESCALA, &modulo);
+
+    if (!o->iniciado)
+    {
+        o->angulo[0] = roll_acel;
+        o->angulo[1] = pitch_acel;
+        o->angulo[2] = 0;
+        o->iniciado = true;
+    }
+    else
+    {
+        // Taxas de Euler (em LSB do giroscópio) a partir das taxas do corpo:
+        //   roll'  = gx + (sen(r) gy + cos(r) gz) tan(p)
+        //   pitch' = cos(r) gy - sen(r) gz
+        //   yaw'   = (sen(r) gy + cos(r) gz) / cos(p)
+        int32_t gx = l->giro[0], gy = l->giro[1], gz = l->giro[2];
+        int32_t sr, cr, sp, cp;
+        cordic_sen_cos(o->angulo[0], &sr, &cr);
+        cordic_sen_cos(o->angulo[1], &sp, &cp);
+        if (cp >= 0 && cp < COS_MIN)
+            cp = COS_MIN;
+        else if (cp < 0 && cp > -COS_MIN)
+            cp = -COS_MIN;
+
+        int32_t a = (sr * gy + cr * gz) >> 15;
+        int32_t taxa[3] = {gx + a * sp / cp, (cr * gy - sr * gz) >> 15, a * 32768 / cp};
+        for (int i = 0; i < 3; i++)
+            o->angulo[i] += (uint32_t)(((int64_t)taxa[i] * o->k_giro) >> 8);
+
+        // Só com aceleração perto de 1 g o acelerômetro mede a gravidade
+        uint32_t norma = (uint32_t)(ax * ax) + (uint32_t)(ay * ay) + (uint32_t)(az * az);
+        if (norma >= o->norma_min && norma <= o->norma_max)
+        {
+            o->angulo[0] += (uint32_t)((int32_t)(roll_acel - o->angulo[0]) >> o->deslocamento);
+            o->angulo[1] += (uint32_t)((int32_t)(pitch_acel - o->angulo[1]) >> o->deslocamento);
+        }
+    }
+
+    for (int i = 0; i < 3; i++)
+        angulos[i] = centigraus(o->angulo[i]);
+}
+
+void orientacao_bench(unsigned n)
+{
+    orientacao_t o;
+    orientacao_iniciar(&o, 16384.0f, 131.0f, 1000);
+
+    uint32_t melhor_us = UINT32_MAX;
+    int16_t angulos[3];
+    for (int rodada = 0; rodada < 3; rodada++)
+    {
+        uint32_t inicio = time_us_32();
+        for (unsigned k = 0; k < n; k++)
+        {
+            // Gravidade girando em torno de X e rotação nos três eixos
+            int16_t fase = (int16_t)(k * 97);
+            sensor_leitura_t l = {{(int16_t)(fase >> 4), (int16_t)(fase >> 1), (int16_t)(16384 - (fase >> 3))},
+                                  {(int16_t)(fase >> 6), (int16_t)(-fase >> 7), 500}};
+            orientacao_atualizar(&o, &l, angulos);
+        }
+        uint32_t duracao = time_us_32() - inicio;
+        if (duracao < melhor_us)
+            melhor_us = duracao;
+    }
+
+    float us = (float)melhor_us / n;
+    float mhz = clock_get_hz(clk_sys) / 1e6f;
+    printf("[ORIENTACAO] %u atualizacoes: %.2f us cada, ~%.0f ciclos a %.0f MHz (%.1f%% de um nucleo a 1 kHz)\n", n, us,
+           us * mhz, mhz, us / 10.0f);
+    printf("[ORIENTACAO] ultimo roll %.2f pitch %.2f yaw %.2f graus\n", angulos[0] / 100.0f, angulos[1] / 100.0f,
+           angulos[2] / 100.0f);
+}
@@ -0,0 +1,46 @@
+#ifndef ORIENTACAO_H
+#define ORIENTACAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor.h"
+
+// Orientação (roll, pitch e yaw) por filtro complementar em ponto fixo, sem
+// float no caminho: o M0+ do RP2040 não tem FPU.
+//  - O giroscópio é integrado a cada amostra, com as taxas do corpo
+//    convertidas em taxas dos ângulos de Euler.
+//  - Roll e pitch são puxados para os ângulos da gravidade medidos pelo
+//    acelerômetro, com constante de tempo ORIENTACAO_TAU_MS, só quando o
+//    módulo da aceleração está perto de 1 g.
+//  - Yaw vem só do giroscópio (não há magnetômetro) e deriva com o tempo.
+//
+// Os ângulos são guardados em BAM de 32 bits (2^32 = 360°, a volta é o
+// estouro natural) e atan2, seno e cosseno são calculados por CORDIC, só
+// com somas e deslocamentos. Os ângulos de Euler degeneram com pitch
+// perto de ±90°.
+
+#define ORIENTACAO_TAU_MS 500 // constante de tempo da correção pelo acelerômetro
+
+typedef struct
+{
+    uint32_t angulo[3];   // roll, pitch e yaw em BAM
+    int32_t k_giro;       // BAM por LSB do giroscópio a cada amostra, em Q8
+    uint32_t norma_min;   // faixa de |a|² (LSB²) em que o acelerômetro corrige
+    uint32_t norma_max;
+    uint8_t deslocamento; // correção por amostra: erro >> deslocamento
+    bool iniciado;        // a primeira amostra parte dos ângulos do acelerômetro
+} orientacao_t;
+
+// Prepara o filtro para as escalas do sensor (LSB/g e LSB/(°/s)) e a taxa
+// da captura. A próxima atualização recomeça pelos ângulos do acelerômetro.
+void orientacao_iniciar(orientacao_t *o, float escala_acel, float escala_giro, uint16_t taxa_hz);
+
+// Integra uma leitura e devolve roll, pitch e yaw em centésimos de grau
+// (-18000 a 18000)
+void orientacao_atualizar(orientacao_t *o, const sensor_leitura_t *l, int16_t angulos[3]);
+
+// Mede o custo de uma atualização (melhor de três rodadas de n atualizações
+// com leituras sintéticas) e mostra em µs e em ciclos do clock do sistema
+void orientacao_bench(unsigned n);
+
+#endif
@@ -0,0 +1,156 @@
+#include <string.h>
+#include "resumo.h"
+#include "caminho_quente.h"
+
+#define TABELA_PASSOS 64 // pontos da tabela do FIR por período de saída
+#define TABELA_TAM (RESUMO_PERIODOS * TABELA_PASSOS)
+
+// Metade do FIR (é simétrico), amostrada no centro de cada passo, em Q15:
+// sinc com corte em meio ciclo por período, janela de Blackman de
+// RESUMO_PERIODOS períodos. Gerada por
+//   h(u) = sinc(u - 4) * (0,42 - 0,5 cos(2πu/8) + 0,08 cos(4πu/8)),
+//   u = (i + 0,5) / 64, normalizada pelo pico.
+static const int16_t fir_tabela[TABELA_TAM / 2] DADOS_QUENTES = {
+    0, 0, 0, 0, 0, 0, 0, -1, -1, -1, -2, -3, -3, -4, -5, -6,
+    -8, -9, -10, -12, -14, -16, -18, -20, -23, -25, -28, -30, -33, -36, -39, -42,
+    -45, -48, -51, -54, -57, -60, -63, -66, -68, -71, -73, -75, -76, -78, -79, -79,
+    -79, -79, -78, -77, -75, -72, -69, -65, -60, -55, -49, -42, -34, -25, -16, -6,
+    6, 18, 31, 45, 61, 77, 94, 112, 131, 150, 171, 193, 215, 238, 262, 287,
+    312, 338, 364, 391, 418, 445, 472, 500, 527, 554, 581, 608, 634, 659, 683, 707,
+    729, 750, 770, 788, 804, 819, 831, 841, 849, 854, 857, 856, 853, 846, 836, 823,
+    806, 785, 760, 731, 699, 661, 620, 574, 524, 469, 409, 345, 277, 203, 125, 43,
+    -44, -136, -231, -332, -436, -544, -656, -772, -892, -1014, -1140, -1268, -1398, -1531, -1666, -1801,
+    -1938, -2076, -2214, -2352, -2489, -2625, -2759, -2892, -3022, -3148, -3272, -3390, -3504, -3613, -3716, -3812,
+    -3902, -3983, -4056, -4121, -4176, -4220, -4254, -4277, -4288, -4287, -4272, -4244, -4202, -4145, -4074, -3986,
+    -3883, -3764, -3627, -3473, -3302, -3113, -2906, -2680, -2436, -2173, -1891, -1590, -1270, -931, -573, -196,
+    200, 615, 1049, 1500, 1970, 2457, 2962, 3484, 4022, 4575, 5145, 5729, 6327, 6938, 7562, 8198,
+    8845, 9502, 10169, 10844, 11527, 12216, 12911, 13610, 14313, 15018, 15724, 16430, 17136, 17839, 18539, 19234,
+    19924, 20607, 21282, 21948, 22603, 23247, 23878, 24496, 25099, 25686, 26256, 26808, 27340, 27853, 28345, 28815,
+    29262, 29685, 30084, 30457, 30805, 31126, 31420, 31686, 31924, 32134, 32314, 32464, 32585, 32676, 32737, 32767,
+};
+
+// Coeficiente na posição i da tabela inteira (espelhada)
+static inline int32_t tabela(uint32_t i)
+{
+    if (i >= TABELA_TAM)
+        i = TABELA_TAM - 1;
+    return fir_tabela[i < TABELA_TAM / 2 ? i : TABELA_TAM - 1 - i];
+}
+
+static void iniciar_estatisticas(resumo_periodo_t *p, int32_t numero)
+{
+    for (int e = 0; e < RESUMO_EIXOS; e++)
+    {
+        p->min[e] = INT16_MAX;
+        p->max[e] = INT16_MIN;
+        p->quadrados[e] = 0;
+    }
+    p->n = 0;
+    p->numero = numero;
+}
+
+void resumo_iniciar(resumo_t *r, uint32_t fator)
+{
+    memset(r, 0, sizeof(*r));
+    r->fator = fator ? fator : 1;
+    r->iniciado = -1;
+}
+
+void CAMINHO_QUENTE(resumo_acumular)(resumo_t *r, const sensor_leitura_t *l, int32_t numero)
+{
+    int16_t v[RESUMO_EIXOS] = {l->acel[0], l->acel[1], l->acel[2], l->giro[0], l->giro[1], l->giro[2]};
+
+    if (r->posicao == 0)
+        iniciar_estatisticas(&r->periodos[r->atual % RESUMO_PERIODOS], numero);
+
+    // A leitura no instante f = (posicao + 0,5) / fator do período atual cai
+    // na posição u = atual - m + 3,5 + f do FIR de cada período m em [0, 8):
+    // oito períodos, de atual - 4 a atual + 3 na primeira metade do período
+    // e de atual - 3 a atual + 4 na segunda
+    bool segunda_metade = 2 * r->posicao + 1 >= r->fator;
+    int32_t m_max = r->atual + (segunda_metade ? RESUMO_PERIODOS / 2 : RESUMO_PERIODOS / 2 - 1);
+    while (r->iniciado < m_max)
+    {
+        resumo_periodo_t *p = &r->periodos[++r->iniciado % RESUMO_PERIODOS];
+        memset(p->fir, 0, sizeof(p->fir));
+        p->peso = 0;
+    }
+
+    // u em 1/256 de passo da tabela, a partir do centro do primeiro passo
+    int32_t fracao = (int32_t)(((2 * r->posicao + 1) * TABELA_PASSOS * 128) / r->fator);
+    int32_t x = (TABELA_PASSOS / 2 + (segunda_metade ? -TABELA_PASSOS : 0)) * 256 + fracao - 128;
+    for (int32_t m = m_max; m > m_max - RESUMO_PERIODOS; m--, x += TABELA_PASSOS * 256)
+    {
+        if (m < 0)
+            break;
+        uint32_t i = x > 0 ? (uint32_t)x >> 8 : 0;
+        int32_t f = x > 0 ? x & 255 : 0;
+        int32_t a = tabela(i);
+        int32_t c = a + (((tabela(i + 1) - a) * f) >> 8);
+
+        resumo_periodo_t *p = &r->periodos[m % RESUMO_PERIODOS];
+        p->peso += c;
+        for (int e = 0; e < RESUMO_EIXOS; e++)
+            p->fir[e] += v[e] * c;
+    }
+
+    resumo_periodo_t *p = &r->periodos[r->atual % RESUMO_PERIODOS];
+    for (int e = 0; e < RESUMO_EIXOS; e++)
+    {
+        if (v[e] < p->min[e])
+            p->min[e] = v[e];
+        if (v[e] > p->max[e])
+            p->max[e] = v[e];
+        p->quadrados[e] += (uint32_t)(v[e] * v[e]);
+    }
+    p->n++;
+
+    if (++r->posicao == r->fator)
+    {
+        r->posicao = 0;
+        r->atual++;
+    }
+}
+
+// Raiz quadrada inteira (arredondada para baixo)
+static uint32_t raiz(uint32_t v)
+{
+    uint32_t r = 0;
+    for (uint32_t bit = 1u << 30; bit; bit >>= 2)
+    {
+        if (v >= r + bit)
+        {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+            r >>= 1;
+    }
+    return r;
+}
+
+bool resumo_obter(resumo_t *r, bool final, resumo_saida_t *saida)
+{
+    int32_t m = r->proximo;
+    // O FIR do período m termina no meio do período m + 4
+    bool coberto = r->atual > m + RESUMO_PERIODOS / 2 ||
+                   (r->atual == m + RESUMO_PERIODOS / 2 && 2 * r->posicao + 1 >= r->fator);
+    bool pendente = m < r->atual || (m == r->atual && r->posicao > 0);
+    if (!coberto && !(final && pendente))
+        return false;
+
+    const resumo_periodo_t *p = &r->periodos[m % RESUMO_PERIODOS];
+    saida->numero = p->numero;
+    for (int e = 0; e < RESUMO_EIXOS; e++)
+    {
+        int64_t media = 0;
+        if (p->peso > 0)
+            media = (p->fir[e] + (p->fir[e] >= 0 ? p->peso / 2 : -p->peso / 2)) / p->peso;
+        saida->media[e] = media > INT16_MAX ? INT16_MAX : media < INT16_MIN ? INT16_MIN : (int16_t)media;
+        saida->min[e] = p->min[e];
+        saida->max[e] = p->max[e];
+        saida->rms[e] = (uint16_t)raiz((uint32_t)(p->quadrados[e] / p->n));
+    }
+    r->proximo++;
+    return true;
+}
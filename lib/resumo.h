@@ -0,0 +1,71 @@
+#ifndef RESUMO_H
+#define RESUMO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor.h"
+
+// Resumo decimado de um sensor: a cada período de saída (fator leituras),
+// média, mínimo, máximo e RMS de cada um dos 6 eixos, para pré-visualizar
+// longas capturas sem ler o log completo.
+//
+// A média sai de um FIR passa-baixas anti-aliasing com corte na metade da
+// taxa de saída (sinc com janela de Blackman de RESUMO_PERIODOS períodos,
+// centrado no meio do período), não da média simples do período: o que
+// passa da metade da taxa de saída é atenuado em vez de dobrar sobre o
+// resultado. Os coeficientes vêm de uma tabela interpolada linearmente,
+// então o mesmo filtro serve para qualquer fator de decimação. Tudo é
+// inteiro: coeficientes Q15, acumuladores de 64 bits e raiz quadrada inteira.
+// Mínimo, máximo e RMS são das leituras do próprio período.
+//
+// Cada período sai RESUMO_PERIODOS / 2 períodos depois do seu fim, quando
+// o FIR o cobriu por inteiro; no fim da captura os pendentes saem com a
+// parte do filtro já acumulada.
+
+#define RESUMO_PERIODOS 8 // comprimento do FIR em períodos de saída
+#define RESUMO_EIXOS 6    // acelerômetro X, Y, Z e giroscópio X, Y, Z
+
+// Acumuladores de um período de saída
+typedef struct
+{
+    int64_t fir[RESUMO_EIXOS];    // soma dos produtos leitura × coeficiente
+    int32_t peso;                 // soma dos coeficientes aplicados
+    int16_t min[RESUMO_EIXOS];
+    int16_t max[RESUMO_EIXOS];
+    uint64_t quadrados[RESUMO_EIXOS];
+    uint32_t n;                   // leituras do período
+    int32_t numero;               // número da primeira leitura do período
+} resumo_periodo_t;
+
+typedef struct
+{
+    resumo_periodo_t periodos[RESUMO_PERIODOS]; // anel indexado pelo período
+    uint32_t fator;   // leituras por período de saída
+    int32_t atual;    // período da próxima leitura
+    uint32_t posicao; // posição da próxima leitura no período
+    int32_t iniciado; // último período com o FIR já começado
+    int32_t proximo;  // próximo período a sair
+} resumo_t;
+
+// Um período pronto, em contagens do sensor
+typedef struct
+{
+    int32_t numero; // numero_amostra da primeira leitura do período
+    int16_t media[RESUMO_EIXOS];
+    int16_t min[RESUMO_EIXOS];
+    int16_t max[RESUMO_EIXOS];
+    uint16_t rms[RESUMO_EIXOS];
+} resumo_saida_t;
+
+// Começa um resumo com fator leituras por período (ao menos 1)
+void resumo_iniciar(resumo_t *r, uint32_t fator);
+
+// Acrescenta uma leitura com o seu número de amostra
+void resumo_acumular(resumo_t *r, const sensor_leitura_t *l, int32_t numero);
+
+// Retira o próximo período pronto; chamar até retornar false depois de cada
+// resumo_acumular. Com final (fim da captura), também os que o FIR ainda
+// não cobriu por inteiro.
+bool resumo_obter(resumo_t *r, bool final, resumo_saida_t *saida);
+
+#endif
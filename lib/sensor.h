@@ -0,0 +1,69 @@
+#ifndef SENSOR_H
+#define SENSOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+
+// Interface dos drivers de sensor inercial. A captura, a fila e a gravação
+// só conhecem estes tipos: um sensor novo entra com um sensor_driver_t e uma
+// linha na lista de drivers de lib/sensores.c, sem mexer no armazenamento.
+
+// Leitura bruta de um sensor de 6 eixos (contagens int16 do fundo de escala)
+typedef struct
+{
+    int16_t acel[3];
+    int16_t giro[3];
+} sensor_leitura_t;
+
+// Configuração pedida pelo config.ini, em unidades físicas. Cada driver
+// escolhe o fundo de escala suportado mais próximo que a cubra.
+typedef struct
+{
+    uint16_t taxa_hz;
+    uint8_t dlpf;      // nível do filtro passa-baixas, 0 (sem filtro) a 6
+    uint8_t acel_g;    // fundo de escala do acelerômetro em g
+    uint16_t giro_dps; // fundo de escala do giroscópio em °/s
+    uint16_t movimento_mg; // limiar da detecção de movimento do próprio sensor (0 = desligada)
+} sensor_config_t;
+
+typedef struct sensor sensor_t;
+
+typedef struct
+{
+    const char *nome;     // modelo, mostrado pelo comando "sensores"
+    uint16_t taxa_max_hz; // maior taxa de saída de dados
+
+    // Verifica se o dispositivo responde e o inicializa
+    bool (*iniciar)(sensor_t *s);
+
+    // Aplica a configuração e guarda a efetiva em s->config. Retorna a taxa
+    // real obtida.
+    uint16_t (*configurar)(sensor_t *s, const sensor_config_t *cfg);
+
+    // Lê até n leituras, da mais antiga para a mais nova. Retorna quantas
+    // foram lidas (0 se o sensor não respondeu). Com movimento_mg, atualiza
+    // s->movimento.
+    unsigned (*ler_lote)(sensor_t *s, sensor_leitura_t *leituras, unsigned n);
+
+    // Sensibilidade na configuração efetiva: LSB/g e LSB/(°/s)
+    void (*escalas)(const sensor_t *s, float *acel, float *giro);
+} sensor_driver_t;
+
+struct sensor
+{
+    const sensor_driver_t *driver;
+    i2c_inst_t *i2c; // NULL em fontes sem barramento
+    uint8_t endereco_i2c;
+    uint8_t id;             // posição fixa, gravada na coluna "sensor"
+    sensor_config_t config; // configuração efetiva (após configurar)
+    bool movimento;         // o sensor sinalizou movimento na última leitura
+};
+
+// MPU6050 no I2C (lib/sensor_mpu6050.c)
+extern const sensor_driver_t sensor_mpu6050;
+
+// Fonte sintética sem barramento, do benchmark de estresse (lib/sensor_sintetico.c)
+extern const sensor_driver_t sensor_sintetico;
+
+#endif
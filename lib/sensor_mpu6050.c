@@ -0,0 +1,82 @@
+#include "sensor.h"
+#include "mpu6050.h"
+#include "caminho_quente.h"
+
+// Driver do MPU6050 sobre lib/mpu6050.c
+
+static const uint8_t acel_g[] = {2, 4, 8, 16};            // por mpu6050_accel_range_t
+static const uint16_t giro_dps[] = {250, 500, 1000, 2000}; // por mpu6050_gyro_range_t
+
+// Menor fundo de escala que cobre o pedido (o maior, se nenhum cobrir)
+static mpu6050_accel_range_t faixa_acel(uint8_t g)
+{
+    unsigned i = 0;
+    while (i < count_of(acel_g) - 1 && acel_g[i] < g)
+        i++;
+    return (mpu6050_accel_range_t)i;
+}
+
+static mpu6050_gyro_range_t faixa_giro(uint16_t dps)
+{
+    unsigned i = 0;
+    while (i < count_of(giro_dps) - 1 && giro_dps[i] < dps)
+        i++;
+    return (mpu6050_gyro_range_t)i;
+}
+
+static bool iniciar(sensor_t *s)
+{
+    // Outro dispositivo no endereço (um RTC, um MPU9250) fica para os
+    // drivers seguintes da lista
+    int id = mpu6050_who_am_i(s->i2c, s->endereco_i2c);
+    if (id != MPU6050_WHO_AM_I_ID && id != MPU6050_WHO_AM_I_CLONE)
+        return false;
+    mpu6050_init(s->i2c, s->endereco_i2c);
+    return true;
+}
+
+static uint16_t configurar(sensor_t *s, const sensor_config_t *cfg)
+{
+    mpu6050_accel_range_t acel = faixa_acel(cfg->acel_g);
+    mpu6050_gyro_range_t giro = faixa_giro(cfg->giro_dps);
+    s->config = *cfg;
+    s->config.acel_g = acel_g[acel];
+    s->config.giro_dps = giro_dps[giro];
+    s->config.dlpf = cfg->dlpf > 6 ? 6 : cfg->dlpf;
+    s->config.taxa_hz = mpu6050_configure(s->i2c, s->endereco_i2c, acel, giro, s->config.dlpf, cfg->taxa_hz);
+    s->config.movimento_mg = mpu6050_configure_motion(s->i2c, s->endereco_i2c, cfg->movimento_mg);
+    s->movimento = false;
+    return s->config.taxa_hz;
+}
+
+// Os registradores de dados guardam só a leitura mais recente. Com a
+// detecção de movimento ligada, o INT_STATUS vem na mesma transação.
+static unsigned CAMINHO_QUENTE(ler_lote)(sensor_t *s, sensor_leitura_t *leituras, unsigned n)
+{
+    int16_t temp;
+    if (n == 0)
+        return 0;
+    if (s->config.movimento_mg == 0)
+        return mpu6050_read_raw(s->i2c, s->endereco_i2c, leituras->acel, leituras->giro, &temp) ? 1 : 0;
+
+    uint8_t status;
+    if (!mpu6050_read_raw_status(s->i2c, s->endereco_i2c, leituras->acel, leituras->giro, &temp, &status))
+        return 0;
+    s->movimento = status & MPU6050_INT_MOT;
+    return 1;
+}
+
+static void escalas(const sensor_t *s, float *acel, float *giro)
+{
+    *acel = mpu6050_accel_scale(faixa_acel(s->config.acel_g));
+    *giro = mpu6050_gyro_scale(faixa_giro(s->config.giro_dps));
+}
+
+const sensor_driver_t sensor_mpu6050 = {
+    .nome = "MPU6050",
+    .taxa_max_hz = 1000, // saída do acelerômetro; o giroscópio chega a 8 kHz sem DLPF
+    .iniciar = iniciar,
+    .configurar = configurar,
+    .ler_lote = ler_lote,
+    .escalas = escalas,
+};
@@ -0,0 +1,50 @@
+#include "sensor.h"
+#include "caminho_quente.h"
+
+// Fonte sintética do benchmark de estresse: uma rampa em cada eixo, gerada
+// sem passar pelo I2C. Aceita qualquer configuração; as escalas tratam o
+// fundo de escala pedido como o int16 inteiro. Nunca sinaliza movimento.
+
+static bool iniciar(sensor_t *s)
+{
+    (void)s;
+    return true;
+}
+
+static uint16_t configurar(sensor_t *s, const sensor_config_t *cfg)
+{
+    s->config = *cfg;
+    s->config.movimento_mg = 0;
+    s->movimento = false;
+    return cfg->taxa_hz;
+}
+
+static unsigned CAMINHO_QUENTE(ler_lote)(sensor_t *s, sensor_leitura_t *leituras, unsigned n)
+{
+    static int16_t rampa = 0;
+    for (unsigned k = 0; k < n; k++)
+    {
+        rampa++;
+        for (int i = 0; i < 3; i++)
+        {
+            leituras[k].acel[i] = (int16_t)((rampa + s->id) * (i + 1));
+            leituras[k].giro[i] = (int16_t)(-(rampa + s->id) * (i + 1));
+        }
+    }
+    return n;
+}
+
+static void escalas(const sensor_t *s, float *acel, float *giro)
+{
+    *acel = 32768.0f / s->config.acel_g;
+    *giro = 32768.0f / s->config.giro_dps;
+}
+
+const sensor_driver_t sensor_sintetico = {
+    .nome = "sintetico",
+    .taxa_max_hz = 8000,
+    .iniciar = iniciar,
+    .configurar = configurar,
+    .ler_lote = ler_lote,
+    .escalas = escalas,
+};
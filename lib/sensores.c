@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "sensores.h"
+#include "caminho_quente.h"
+
+// Drivers tentados em cada posição, na ordem
+static const sensor_driver_t *const drivers[] = {&sensor_mpu6050};
+
+// Endereços de cada barramento, na ordem dos identificadores (e da rajada)
+static const uint8_t enderecos[] = {0x68, 0x69};
+
+static sensor_t encontrados[SENSORES_MAX];
+static unsigned qtd_encontrados;
+static sensor_t sinteticos[SENSORES_MAX];
+static unsigned qtd_sinteticos;
+
+// Tabela em uso pela captura: a dos sensores encontrados ou a sintética
+static sensor_t *ativos = encontrados;
+static unsigned qtd;
+
+// Escalas por identificador, para converter os registros sem percorrer a tabela
+static float escala_acel[SENSORES_MAX];
+static float escala_giro[SENSORES_MAX];
+
+unsigned sensores_detectar(bool usar_i2c1)
+{
+    i2c_inst_t *barramentos[] = {i2c0, i2c1};
+    qtd_encontrados = 0;
+    for (unsigned b = 0; b < count_of(barramentos); b++)
+    {
+        if (b == 1 && !usar_i2c1)
+            break;
+        for (unsigned e = 0; e < count_of(enderecos); e++)
+        {
+            sensor_t *s = &encontrados[qtd_encontrados];
+            s->i2c = barramentos[b];
+            s->endereco_i2c = enderecos[e];
+            s->id = (uint8_t)(b * count_of(enderecos) + e);
+            for (unsigned d = 0; d < count_of(drivers); d++)
+            {
+                s->driver = drivers[d];
+                if (s->driver->iniciar(s))
+                {
+                    printf("[SENSOR] %u: %s em i2c%u/0x%02x\n", s->id, s->driver->nome, b, s->endereco_i2c);
+                    qtd_encontrados++;
+                    break;
+                }
+            }
+        }
+    }
+    if (qtd_encontrados == 0)
+        printf("[SENSOR] Nenhum sensor encontrado\n");
+    ativos = encontrados;
+    qtd = qtd_encontrados;
+    return qtd;
+}
+
+void sensores_fonte_sintetica(bool ligar)
+{
+    if (!ligar)
+    {
+        ativos = encontrados;
+        qtd = qtd_encontrados;
+        return;
+    }
+
+    qtd_sinteticos = qtd_encontrados ? qtd_encontrados : 1;
+    for (unsigned i = 0; i < qtd_sinteticos; i++)
+    {
+        sensor_t *s = &sinteticos[i];
+        s->driver = &sensor_sintetico;
+        s->i2c = NULL;
+        s->endereco_i2c = 0;
+        s->id = qtd_encontrados ? encontrados[i].id : 0;
+        s->driver->iniciar(s);
+    }
+    ativos = sinteticos;
+    qtd = qtd_sinteticos;
+}
+
+unsigned sensores_qtd(void)
+{
+    return qtd;
+}
+
+sensor_t *sensores_obter(unsigned i)
+{
+    return &ativos[i];
+}
+
+bool sensores_no_i2c1(void)
+{
+    for (unsigned i = 0; i < qtd; i++)
+        if (ativos[i].i2c == i2c1)
+            return true;
+    return false;
+}
+
+uint16_t sensores_configurar(const sensor_config_t *cfg)
+{
+    uint16_t taxa = cfg->taxa_hz;
+    for (unsigned i = 0; i < qtd; i++)
+    {
+        sensor_t *s = &ativos[i];
+        uint16_t real = s->driver->configurar(s, cfg);
+        if (i == 0 || real < taxa)
+            taxa = real;
+        s->driver->escalas(s, &escala_acel[s->id], &escala_giro[s->id]);
+    }
+    return taxa;
+}
+
+void CAMINHO_QUENTE(sensores_escalas)(uint8_t id, float *acel, float *giro)
+{
+    *acel = escala_acel[id % SENSORES_MAX];
+    *giro = escala_giro[id % SENSORES_MAX];
+}
+
+unsigned CAMINHO_QUENTE(sensores_ler)(unsigned i, sensor_leitura_t *leituras, unsigned n)
+{
+    return ativos[i].driver->ler_lote(&ativos[i], leituras, n);
+}
+
+void sensores_imprimir(void)
+{
+    if (qtd == 0)
+        printf("[SENSOR] Nenhum sensor ativo\n");
+    for (unsigned i = 0; i < qtd; i++)
+    {
+        const sensor_t *s = &ativos[i];
+        printf("[SENSOR] %u: %-9s ", s->id, s->driver->nome);
+        if (s->i2c)
+            printf("i2c%u/0x%02x", s->i2c == i2c1, s->endereco_i2c);
+        else
+            printf("%-10s", "-");
+        printf(" ate %5u Hz", s->driver->taxa_max_hz);
+
+        // As escalas só existem depois da primeira captura (configurar)
+        if (s->config.acel_g == 0)
+        {
+            printf(", ainda nao configurado\n");
+            continue;
+        }
+        float acel, giro;
+        s->driver->escalas(s, &acel, &giro);
+        printf(", +-%u g (%.1f LSB/g), +-%u dps (%.2f LSB/dps)\n", s->config.acel_g, acel, s->config.giro_dps, giro);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef SENSORES_H
+#define SENSORES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor.h"
+
+// Até quatro sensores: 0x68 e 0x69 em cada um dos barramentos i2c0 e i2c1.
+// O identificador de cada posição é fixo e vai em cada registro do log:
+// 0 = i2c0/0x68, 1 = i2c0/0x69, 2 = i2c1/0x68, 3 = i2c1/0x69. Em cada
+// posição os drivers de lib/sensor.h são tentados na ordem da lista.
+//
+// A cada período a captura lê todos os sensores encontrados em uma rajada,
+// sempre na ordem dos identificadores.
+
+#define SENSORES_MAX 4
+
+// Procura um sensor em cada posição do i2c0 e, se usar_i2c1, do i2c1, e
+// inicializa os que responderem. Os barramentos já devem estar inicializados
+// e livres. Retorna a quantidade encontrada.
+unsigned sensores_detectar(bool usar_i2c1);
+
+// Troca os sensores encontrados pela fonte sintética (benchmark de estresse),
+// com os mesmos identificadores (ou um sensor 0, se não houver nenhum), e
+// volta a eles com ligar = false. Só com a captura parada.
+void sensores_fonte_sintetica(bool ligar);
+
+// Quantidade de sensores ativos
+unsigned sensores_qtd(void);
+
+// Sensor na posição 'i' da rajada (0 .. sensores_qtd() - 1)
+sensor_t *sensores_obter(unsigned i);
+
+// Verdadeiro se algum sensor ativo está no i2c1, compartilhado com o display
+bool sensores_no_i2c1(void);
+
+// Aplica a configuração a todos os sensores ativos. Retorna a menor taxa
+// real entre eles.
+uint16_t sensores_configurar(const sensor_config_t *cfg);
+
+// Sensibilidade (LSB/g e LSB/(°/s)) do sensor com o identificador 'id' na
+// última configuração, guardada por sensores_configurar para a gravação
+void sensores_escalas(uint8_t id, float *acel, float *giro);
+
+// Lê até n leituras do sensor na posição 'i' da rajada
+unsigned sensores_ler(unsigned i, sensor_leitura_t *leituras, unsigned n);
+
+// Lista os sensores ativos e os metadados de cada um
+void sensores_imprimir(void);
+
+#endif
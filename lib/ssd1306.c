@@ -1,5 +1,18 @@
 #include "ssd1306.h"
+#include <string.h>
+#include "hardware/irq.h"
 #include "font.h"
+#include "arena.h"
+
+// Display atendido pela IRQ de DMA (há um único display no projeto)
+static ssd1306_t *dma_ssd = NULL;
+
+// Buffers do único display, na arena: comportam um painel de até WIDTH x HEIGHT
+#define SSD1306_BUFSIZE (WIDTH * HEIGHT / 8 + 1)
+static uint8_t ram_buffer[SSD1306_BUFSIZE] ARENA;
+static uint8_t shadow_buffer[SSD1306_BUFSIZE] ARENA;
+static uint8_t tx_buffer[SSD1306_BUFSIZE] ARENA;
+static uint16_t dma_buffer[SSD1306_BUFSIZE + 8] ARENA;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
@@ -8,9 +21,37 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->address = address;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->ram_buffer = ram_buffer;
+  memset(ram_buffer, 0, sizeof(ram_buffer));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->shadow_buffer = shadow_buffer;
+  memset(shadow_buffer, 0, sizeof(shadow_buffer));
+  ssd->tx_buffer = tx_buffer;
+  ssd->send_page = 1; // nenhuma página pendente
+  ssd->send_p1 = 0;
+  ssd->tx_buffer[0] = 0x40;
+  ssd->dma_chan = -1;
+  ssd->dma_busy = false;
+  // O conteúdo do painel é desconhecido: o primeiro envio é completo
+  ssd->full_refresh = true;
+  ssd1306_mark_dirty(ssd, 0, ssd->width - 1, 0, ssd->pages - 1);
+}
+
+// Marca a região (colunas x0..x1, páginas p0..p1) como alterada
+void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  if (!ssd->dirty) {
+    ssd->dirty = true;
+    ssd->dirty_x0 = x0;
+    ssd->dirty_x1 = x1;
+    ssd->dirty_p0 = p0;
+    ssd->dirty_p1 = p1;
+    return;
+  }
+  if (x0 < ssd->dirty_x0) ssd->dirty_x0 = x0;
+  if (x1 > ssd->dirty_x1) ssd->dirty_x1 = x1;
+  if (p0 < ssd->dirty_p0) ssd->dirty_p0 = p0;
+  if (p1 > ssd->dirty_p1) ssd->dirty_p1 = p1;
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
@@ -41,7 +82,119 @@ void ssd1306_config(ssd1306_t *ssd) {
   ssd1306_command(ssd, SET_DISP | 0x01);
 }
 
+static void __not_in_flash_func(ssd1306_dma_irq_handler)(void) {
+  ssd1306_t *ssd = dma_ssd;
+  if (ssd == NULL || !dma_channel_get_irq1_status(ssd->dma_chan))
+    return;
+  dma_channel_acknowledge_irq1(ssd->dma_chan);
+  ssd->dma_busy = false;
+  if (ssd->dma_done)
+    ssd->dma_done(ssd->dma_ctx);
+}
+
+// Passa o envio do framebuffer para DMA. 'done' é chamado na IRQ (DMA_IRQ_1)
+// quando o último byte entra na FIFO do I2C. Sem canal livre o envio continua
+// bloqueante.
+bool ssd1306_init_dma(ssd1306_t *ssd, void (*done)(void *ctx), void *ctx) {
+  int chan = dma_claim_unused_channel(false);
+  if (chan < 0)
+    return false;
+
+  // Cabeçalho de comandos (7 palavras) + controle + framebuffer
+  ssd->dma_buffer = dma_buffer;
+  ssd->dma_done = done;
+  ssd->dma_ctx = ctx;
+
+  ssd->dma_cfg = dma_channel_get_default_config(chan);
+  channel_config_set_transfer_data_size(&ssd->dma_cfg, DMA_SIZE_16);
+  channel_config_set_read_increment(&ssd->dma_cfg, true);
+  channel_config_set_write_increment(&ssd->dma_cfg, false);
+  channel_config_set_dreq(&ssd->dma_cfg, i2c_get_dreq(ssd->i2c_port, true));
+
+  dma_ssd = ssd;
+  dma_channel_set_irq1_enabled(chan, true);
+  irq_add_shared_handler(DMA_IRQ_1, ssd1306_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(DMA_IRQ_1, true);
+  ssd->dma_chan = chan;
+  return true;
+}
+
+// Interrompe o envio DMA em andamento e descarta as páginas pendentes. O
+// painel fica com um quadro parcial e o shadow_buffer já não o reflete: o
+// próximo envio é completo.
+void ssd1306_abort(ssd1306_t *ssd) {
+  if (ssd->dma_chan < 0)
+    return;
+  // RP2040-E13: o abort pode levantar a IRQ do canal, desabilitada em volta dele
+  dma_channel_set_irq1_enabled(ssd->dma_chan, false);
+  dma_channel_abort(ssd->dma_chan);
+  dma_channel_acknowledge_irq1(ssd->dma_chan);
+  dma_channel_set_irq1_enabled(ssd->dma_chan, true);
+  ssd->dma_busy = false;
+  ssd->send_page = ssd->send_p1 + 1; // as páginas que faltavam vão no próximo envio
+
+  // Descarta o que restou na FIFO (STOP no barramento) e limpa o abort
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  if (!(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS))
+    hw->enable = I2C_IC_ENABLE_ENABLE_BITS | I2C_IC_ENABLE_ABORT_BITS;
+  (void)hw->clr_tx_abrt;
+
+  ssd->full_refresh = true;
+  ssd1306_mark_dirty(ssd, 0, ssd->width - 1, 0, ssd->pages - 1);
+}
+
+// Verdadeiro enquanto houver envio em andamento (DMA ou FIFO do I2C não vazia).
+// Um abort do I2C (NACK, perda de arbitragem) esvazia a FIFO e para o DREQ:
+// sem tratá-lo aqui o DMA nunca terminaria.
+bool ssd1306_busy(ssd1306_t *ssd) {
+  if (ssd->dma_chan < 0)
+    return false;
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+    ssd1306_abort(ssd);
+    return false;
+  }
+  if (ssd->dma_busy)
+    return true;
+  return !(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS);
+}
+
+void ssd1306_wait_idle(ssd1306_t *ssd) {
+  while (ssd1306_busy(ssd))
+    tight_loop_contents();
+}
+
+// Envia a janela já montada em tx_buffer em uma única sequência DMA:
+// comandos de endereço (controle 0x00) e dados (controle 0x40), cada
+// transação encerrada com STOP.
+static void ssd1306_send_window_dma(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1, size_t n) {
+  ssd1306_wait_idle(ssd);
+
+  uint16_t *w = ssd->dma_buffer;
+  size_t k = 0;
+  w[k++] = 0x00; // Co = 0, D/C = 0: seguem só comandos
+  w[k++] = SET_COL_ADDR;
+  w[k++] = x0;
+  w[k++] = x1;
+  w[k++] = SET_PAGE_ADDR;
+  w[k++] = p0;
+  w[k++] = p1 | I2C_IC_DATA_CMD_STOP_BITS;
+  for (size_t i = 0; i < n; ++i) // tx_buffer[0] já é o controle 0x40
+    w[k++] = ssd->tx_buffer[i];
+  w[k - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+  // Garante o endereço do display no controlador antes do DMA
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  hw->enable = 0;
+  hw->tar = ssd->address;
+  hw->enable = 1;
+
+  ssd->dma_busy = true;
+  dma_channel_configure(ssd->dma_chan, &ssd->dma_cfg, &hw->data_cmd, w, k, true);
+}
+
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_wait_idle(ssd); // não intercala com um envio DMA em andamento
   ssd->port_buffer[1] = command;
   i2c_write_blocking(
     ssd->i2c_port,
@@ -52,69 +205,140 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   );
 }
 
-void ssd1306_send_data(ssd1306_t *ssd) {
+// Prepara o envio da janela de colunas/páginas que mudou desde o último
+// envio: o shadow_buffer passa a ter o quadro a transmitir e a janela fica
+// pendente para ssd1306_send_page. Retorna o número de páginas (0 se o
+// quadro for igual ao que já está no painel).
+uint8_t ssd1306_prepare(ssd1306_t *ssd) {
+  if (!ssd->dirty)
+    return 0;
+  ssd->dirty = false;
+
+  // Reduz a região suja aos bytes que realmente diferem do painel
+  uint8_t x0 = 0xFF, x1 = 0, p0 = 0xFF, p1 = 0;
+  for (uint8_t x = ssd->dirty_x0; x <= ssd->dirty_x1; ++x) {
+    const uint8_t *col = &ssd->ram_buffer[1 + x * ssd->pages];
+    const uint8_t *ant = &ssd->shadow_buffer[1 + x * ssd->pages];
+    for (uint8_t p = ssd->dirty_p0; p <= ssd->dirty_p1; ++p) {
+      if (ssd->full_refresh || col[p] != ant[p]) {
+        if (x < x0) x0 = x;
+        x1 = x;
+        if (p < p0) p0 = p;
+        if (p > p1) p1 = p;
+      }
+    }
+  }
+  if (x0 > x1)
+    return 0; // quadro inalterado
+
+  for (uint8_t x = x0; x <= x1; ++x) {
+    for (uint8_t p = p0; p <= p1; ++p) {
+      size_t i = 1 + x * ssd->pages + p;
+      ssd->shadow_buffer[i] = ssd->ram_buffer[i];
+    }
+  }
+  ssd->full_refresh = false;
+
+  ssd->send_x0 = x0;
+  ssd->send_x1 = x1;
+  ssd->send_page = p0;
+  ssd->send_p1 = p1;
+  return p1 - p0 + 1;
+}
+
+// Envia a próxima página da janela preparada (até 'width' bytes), vinda do
+// shadow_buffer: desenhos feitos entre duas páginas ficam para o próximo
+// envio. Retorna false se não há página pendente.
+bool ssd1306_send_page(ssd1306_t *ssd) {
+  if (ssd->send_page > ssd->send_p1)
+    return false;
+  uint8_t p = ssd->send_page++;
+
+  size_t n = 1; // tx_buffer[0] é o controle 0x40
+  for (uint8_t x = ssd->send_x0; x <= ssd->send_x1; ++x)
+    ssd->tx_buffer[n++] = ssd->shadow_buffer[1 + x * ssd->pages + p];
+
+  if (ssd->dma_chan >= 0) {
+    ssd1306_send_window_dma(ssd, ssd->send_x0, ssd->send_x1, p, p, n);
+    return true;
+  }
+
   ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
+  ssd1306_command(ssd, ssd->send_x0);
+  ssd1306_command(ssd, ssd->send_x1);
   ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
+  ssd1306_command(ssd, p);
+  ssd1306_command(ssd, p);
   i2c_write_blocking(
     ssd->i2c_port,
     ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
+    ssd->tx_buffer,
+    n,
     false
   );
+  return true;
+}
+
+// Envia ao painel, página a página, só o que mudou desde o último envio
+void ssd1306_send_data(ssd1306_t *ssd) {
+  ssd1306_prepare(ssd);
+  while (ssd1306_send_page(ssd))
+    ;
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
   uint16_t index = (y >> 3) + (x << 3) + 1;
   uint8_t pixel = (y & 0b111);
+  ssd1306_mark_dirty(ssd, x, x, y >> 3, y >> 3);
   if (value)
     ssd->ram_buffer[index] |= (1 << pixel);
   else
     ssd->ram_buffer[index] &= ~(1 << pixel);
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
+// Aplica 'mask' em um byte do framebuffer (liga ou desliga os bits)
+static inline void ssd1306_apply(uint8_t *byte, uint8_t mask, bool value) {
+  if (value)
+    *byte |= mask;
+  else
+    *byte &= ~mask;
+}
 
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+  // Cada byte guarda 8 pixels de uma coluna: basta um memset
+  memset(&ssd->ram_buffer[1], value ? 0xFF : 0x00, ssd->bufsize - 1);
+  ssd1306_mark_dirty(ssd, 0, ssd->width - 1, 0, ssd->pages - 1);
 }
 
-
-
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
-  }
+  if (width == 0 || height == 0)
+    return;
+  uint8_t right = left + width - 1;
+  uint8_t bottom = top + height - 1;
 
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    // Retângulo cheio: uma coluna (bytes inteiros + bordas mascaradas) por vez
+    for (uint8_t x = left; x <= right; ++x)
+      ssd1306_vline(ssd, x, top, bottom, value);
+    return;
   }
+  ssd1306_hline(ssd, left, right, top, value);
+  ssd1306_hline(ssd, left, right, bottom, value);
+  ssd1306_vline(ssd, left, top, bottom, value);
+  ssd1306_vline(ssd, right, top, bottom, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
+    // Linhas horizontais e verticais usam os caminhos rápidos
+    if (y0 == y1) {
+        ssd1306_hline(ssd, x0 < x1 ? x0 : x1, x0 < x1 ? x1 : x0, y0, value);
+        return;
+    }
+    if (x0 == x1) {
+        ssd1306_vline(ssd, x0, y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0, value);
+        return;
+    }
+
     int dx = abs(x1 - x0);
     int dy = abs(y1 - y0);
 
@@ -144,13 +368,50 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 
 
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  if (y >= ssd->height || x0 >= ssd->width)
+    return;
+  if (x1 >= ssd->width)
+    x1 = ssd->width - 1;
+
+  // Mesmo bit da mesma página em colunas consecutivas (passo = nº de páginas)
+  uint8_t page = y >> 3;
+  uint8_t mask = 1 << (y & 0b111);
+  uint8_t *byte = &ssd->ram_buffer[1 + x0 * ssd->pages + page];
+  for (uint8_t x = x0; x <= x1; ++x, byte += ssd->pages)
+    ssd1306_apply(byte, mask, value);
+  ssd1306_mark_dirty(ssd, x0, x1, page, page);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  if (x >= ssd->width || y0 >= ssd->height)
+    return;
+  if (y1 >= ssd->height)
+    y1 = ssd->height - 1;
+
+  // As páginas de uma coluna são contíguas: bordas mascaradas e miolo com memset
+  uint8_t *col = &ssd->ram_buffer[1 + x * ssd->pages];
+  uint8_t p0 = y0 >> 3, p1 = y1 >> 3;
+  uint8_t m0 = 0xFF << (y0 & 0b111);
+  uint8_t m1 = 0xFF >> (7 - (y1 & 0b111));
+  if (p0 == p1) {
+    ssd1306_apply(&col[p0], m0 & m1, value);
+  } else {
+    ssd1306_apply(&col[p0], m0, value);
+    memset(&col[p0 + 1], value ? 0xFF : 0x00, p1 - p0 - 1);
+    ssd1306_apply(&col[p1], m1, value);
+  }
+  ssd1306_mark_dirty(ssd, x, x, p0, p1);
+}
+
+// Desloca as páginas p0..p1 uma coluna para a esquerda e limpa a última
+// coluna (gráficos com rolagem: só a coluna nova precisa ser desenhada)
+void ssd1306_scroll_left(ssd1306_t *ssd, uint8_t p0, uint8_t p1) {
+  uint8_t n = p1 - p0 + 1;
+  uint8_t *col = &ssd->ram_buffer[1 + p0];
+  for (uint8_t x = 0; x + 1 < ssd->width; ++x, col += ssd->pages)
+    memcpy(col, col + ssd->pages, n);
+  memset(col, 0x00, n);
+  ssd1306_mark_dirty(ssd, 0, ssd->width - 1, p0, p1);
 }
 
 // Função para desenhar um caractere
@@ -169,15 +430,32 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
     index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
   }
 
-  // Desenha o caractere na tela
-  for (uint8_t i = 0; i < 8; ++i)
+  if (x >= ssd->width || y >= ssd->height)
+    return;
+
+  // Cada byte da fonte é uma coluna do glifo, no mesmo formato do framebuffer:
+  // com y múltiplo de 8 o byte é copiado direto; senão é dividido em duas páginas
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 0b111;
+  uint8_t last_x = x;
+  for (uint8_t i = 0; i < 8 && x + i < ssd->width; ++i)
   {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
+    uint8_t line = font[index + i]; // Acessa a coluna correspondente do caractere na fonte
+    uint8_t *col = &ssd->ram_buffer[1 + (x + i) * ssd->pages];
+    if (shift == 0)
+    {
+      col[page] = line;
+    }
+    else
     {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
+      col[page] = (col[page] & ~(0xFF << shift)) | (line << shift);
+      if (page + 1 < ssd->pages)
+        col[page + 1] = (col[page + 1] & ~(0xFF >> (8 - shift))) | (line >> (8 - shift));
     }
+    last_x = x + i;
   }
+  uint8_t last_page = (shift && page + 1 < ssd->pages) ? page + 1 : page;
+  ssd1306_mark_dirty(ssd, x, last_x, page, last_page);
 }
 
 // Função para desenhar uma string
@@ -201,8 +479,8 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
 
 void init_Display(ssd1306_t *ssd)
 {
-  // I2C Initialisation. Using it at 400Khz.
-  i2c_init(I2C_PORT_DISP, 400 * 1000);
+  // I2C Initialisation. Using it at I2C_BAUD_DISP (1 MHz, fast-mode plus).
+  i2c_init(I2C_PORT_DISP, I2C_BAUD_DISP);
   gpio_set_function(I2C_SDA_DISP, GPIO_FUNC_I2C);                   // Set the GPIO pin function to I2C
   gpio_set_function(I2C_SCL_DISP, GPIO_FUNC_I2C);                   // Set the GPIO pin function to I2C
   gpio_pull_up(I2C_SDA_DISP);                                       // Pull up the data line
@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
 
 #define WIDTH 128
 #define HEIGHT 64
@@ -9,6 +10,8 @@
 #define I2C_SDA_DISP 14
 #define I2C_SCL_DISP 15
 #define endereco 0x3C
+// Fast-mode plus (1 MHz). Use 400 * 1000 se o painel não tolerar.
+#define I2C_BAUD_DISP (1000 * 1000)
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -37,12 +40,32 @@ typedef struct {
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  uint8_t *shadow_buffer;  // conteúdo atualmente no painel
+  uint8_t *tx_buffer;      // janela a transmitir (0x40 + dados)
+  bool dirty;              // há escritas desde o último envio
+  bool full_refresh;       // o painel não reflete o shadow_buffer (início)
+  uint8_t dirty_x0, dirty_x1, dirty_p0, dirty_p1; // região suja (colunas/páginas)
+  uint8_t send_x0, send_x1;    // colunas da janela preparada para envio
+  uint8_t send_page, send_p1;  // próxima e última página a enviar
+  int dma_chan;                // canal DMA do envio (-1: envio bloqueante)
+  dma_channel_config dma_cfg;
+  uint16_t *dma_buffer;        // comandos + dados no formato do IC_DATA_CMD
+  volatile bool dma_busy;
+  void (*dma_done)(void *ctx); // chamado na IRQ ao fim do DMA
+  void *dma_ctx;
 } ssd1306_t;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+uint8_t ssd1306_prepare(ssd1306_t *ssd);
+bool ssd1306_send_page(ssd1306_t *ssd);
+void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
+bool ssd1306_init_dma(ssd1306_t *ssd, void (*done)(void *ctx), void *ctx);
+bool ssd1306_busy(ssd1306_t *ssd);
+void ssd1306_abort(ssd1306_t *ssd);
+void ssd1306_wait_idle(ssd1306_t *ssd);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -50,6 +73,7 @@ void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value);
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
+void ssd1306_scroll_left(ssd1306_t *ssd, uint8_t p0, uint8_t p1);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
 void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
 
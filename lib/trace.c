@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <string.h>
+#include "trace.h"
+#include "ff.h"
+
+trace_registro_t trace_anel[TRACE_NUCLEOS][TRACE_TAM];
+uint32_t trace_pos[TRACE_NUCLEOS];
+volatile bool trace_pausado = false;
+
+void trace_limpar(void)
+{
+    for (int n = 0; n < TRACE_NUCLEOS; n++)
+        trace_pos[n] = 0;
+}
+
+// Primeiro registro válido e quantidade no anel de um núcleo
+static uint32_t trace_janela(int nucleo, uint32_t *qtd)
+{
+    uint32_t pos = trace_pos[nucleo];
+    *qtd = pos < TRACE_TAM ? pos : TRACE_TAM;
+    return pos - *qtd;
+}
+
+void trace_despejar_usb(void)
+{
+    trace_pausado = true;
+    for (int n = 0; n < TRACE_NUCLEOS; n++)
+    {
+        uint32_t qtd;
+        uint32_t inicio = trace_janela(n, &qtd);
+        printf("[TRACE] nucleo %d: %lu registros\n", n, (unsigned long)qtd);
+        for (uint32_t i = 0; i < qtd; i++)
+        {
+            trace_registro_t r = trace_anel[n][(inicio + i) & (TRACE_TAM - 1)];
+            const uint8_t *b = (const uint8_t *)&r;
+            printf("[TRACE] ");
+            for (size_t k = 0; k < sizeof(r); k++)
+                printf("%02x", b[k]);
+            printf("\n");
+        }
+    }
+    trace_pausado = false;
+}
+
+int trace_gravar_arquivo(const char *nome)
+{
+    FIL file;
+    UINT bw;
+    trace_pausado = true; // a própria gravação geraria eventos de SD
+    FRESULT fr = f_open(&file, nome, FA_WRITE | FA_CREATE_ALWAYS);
+    if (fr != FR_OK)
+    {
+        trace_pausado = false;
+        return fr;
+    }
+    fr = f_write(&file, TRACE_MAGIC, 4, &bw);
+
+    for (int n = 0; n < TRACE_NUCLEOS && fr == FR_OK; n++)
+    {
+        uint32_t qtd;
+        uint32_t inicio = trace_janela(n, &qtd);
+        for (uint32_t i = 0; i < qtd && fr == FR_OK; i++)
+        {
+            trace_registro_t r = trace_anel[n][(inicio + i) & (TRACE_TAM - 1)];
+            fr = f_write(&file, &r, sizeof(r), &bw);
+        }
+    }
+
+    FRESULT fr_close = f_close(&file);
+    trace_pausado = false;
+    return fr != FR_OK ? fr : fr_close;
+}
@@ -0,0 +1,87 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+// Trace dos caminhos críticos: cada evento é um registro de 8 bytes (tempo em
+// µs, evento, núcleo e argumento) em um anel por núcleo, sobrescrevendo os
+// mais antigos. Com TRACE=0 (padrão) as macros não geram código. O comando
+// "trace" do console despeja o anel em hexadecimal pela USB e "trace sd"
+// grava trace.bin no cartão; Arquivos/trace_json.py converte os dois para o
+// formato JSON de trace do Chrome (chrome://tracing ou ui.perfetto.dev).
+
+#ifndef TRACE
+#define TRACE 0
+#endif
+
+#define TRACE_TAM 1024 // registros por núcleo (potência de 2)
+#define TRACE_NUCLEOS 2
+
+#define TRACE_MAGIC "TRC1" // início de trace.bin
+
+typedef enum
+{
+    TRACE_LEITURA,    // leitura do MPU6050 na vCapturaTask
+    TRACE_FILA,       // amostra na fila (arg: ocupação)
+    TRACE_BLOCO,      // bloco formatado/comprimido pronto para o SD (arg: bytes)
+    TRACE_GRAVACAO,   // gravação do bloco: f_open até f_close
+    TRACE_SYNC,       // f_close/f_sync (FAT e diretório)
+    TRACE_SD_BLOCO,   // sd_write_block: um setor no cartão
+    TRACE_SPI_DMA,    // spi_transfer por DMA (arg: bytes)
+    TRACE_SD_OCUPADO, // sd_wait_ready: cartão ocupado programando
+    TRACE_EVENTOS
+} trace_evento_t;
+
+// Fase do evento, nos bits altos do campo 'evento'
+#define TRACE_FASE_INICIO 0x00
+#define TRACE_FASE_FIM 0x80
+#define TRACE_FASE_INSTANTE 0x40
+
+typedef struct
+{
+    uint32_t t_us;
+    uint8_t evento; // trace_evento_t | TRACE_FASE_*
+    uint8_t nucleo;
+    uint16_t arg;
+} trace_registro_t;
+
+extern trace_registro_t trace_anel[TRACE_NUCLEOS][TRACE_TAM];
+extern uint32_t trace_pos[TRACE_NUCLEOS];
+extern volatile bool trace_pausado; // durante o despejo, para o anel não mudar
+
+static inline void trace_registrar(uint8_t evento, uint16_t arg)
+{
+    if (trace_pausado)
+        return;
+    uint nucleo = get_core_num();
+    uint32_t irq = save_and_disable_interrupts(); // tarefas e IRQs do mesmo núcleo
+    trace_registro_t *r = &trace_anel[nucleo][trace_pos[nucleo]++ & (TRACE_TAM - 1)];
+    r->t_us = time_us_32();
+    r->evento = evento;
+    r->nucleo = (uint8_t)nucleo;
+    r->arg = arg;
+    restore_interrupts(irq);
+}
+
+#if TRACE
+#define TRACE_INICIO(ev, arg) trace_registrar((ev) | TRACE_FASE_INICIO, (arg))
+#define TRACE_FIM(ev, arg) trace_registrar((ev) | TRACE_FASE_FIM, (arg))
+#define TRACE_MARCA(ev, arg) trace_registrar((ev) | TRACE_FASE_INSTANTE, (arg))
+#else
+#define TRACE_INICIO(ev, arg) ((void)0)
+#define TRACE_FIM(ev, arg) ((void)0)
+#define TRACE_MARCA(ev, arg) ((void)0)
+#endif
+
+// Esvazia os anéis
+void trace_limpar(void);
+
+// Imprime os registros, do mais antigo ao mais novo, como linhas "[TRACE] <hex>"
+void trace_despejar_usb(void);
+
+// Grava TRACE_MAGIC e os registros em um arquivo do volume montado
+int trace_gravar_arquivo(const char *nome);
+
+#endif
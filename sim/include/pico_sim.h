@@ -0,0 +1,207 @@
+#ifndef PICO_SIM_H
+#define PICO_SIM_H
+
+// Substitutos mínimos do pico-sdk para o build no PC (sim/). Só o que o
+// firmware usa: GPIO e botões, I2C (MPU6050 simulado e display mudo), ADC,
+// DMA/IRQ (sempre indisponíveis: o display cai no envio bloqueante) e tempo.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define __not_in_flash_func(func_name) func_name
+#define __not_in_flash(group)
+#define __scratch_x(group)
+#define __scratch_y(group)
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#define tight_loop_contents() ((void)0)
+
+// Tempo (relógio monotônico do PC)
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+absolute_time_t get_absolute_time(void);
+uint32_t to_ms_since_boot(absolute_time_t t);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+void busy_wait_us(uint64_t us);
+
+// Alarmes de hardware (pico/time.h): nenhum livre, e a captura acima do
+// tick cai nas rajadas em lotes por tick
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+struct repeating_timer
+{
+    int64_t delay_us;
+    repeating_timer_callback_t callback;
+    void *user_data;
+};
+
+static inline bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data,
+                                          repeating_timer_t *out)
+{
+    (void)delay_us, (void)callback, (void)user_data, (void)out;
+    return false;
+}
+static inline bool cancel_repeating_timer(repeating_timer_t *timer) { (void)timer; return false; }
+
+// Núcleo e interrupções: um único "núcleo", sem interrupções a mascarar
+static inline uint get_core_num(void) { return 0; }
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+void stdio_init_all(void);
+#define PICO_ERROR_TIMEOUT -1
+#define PICO_ERROR_GENERIC -2
+int getchar_timeout_us(uint32_t timeout_us); // console USB: stdin do processo
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param);
+// Chama o callback do stdio se houver dado no stdin: a tarefa Stdin do
+// sim_main.c faz a vez da IRQ do USB
+void sim_stdio_verificar(void);
+void panic_unsupported(void);
+void reset_usb_boot(uint32_t gpio_mask, uint32_t disable_interface_mask);
+
+// GPIO
+#define GPIO_OUT 1
+#define GPIO_IN 0
+#define GPIO_IRQ_EDGE_FALL 0x4u
+#define GPIO_IRQ_EDGE_RISE 0x8u
+
+enum gpio_function
+{
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_NULL = 0x1f
+};
+
+enum gpio_drive_strength
+{
+    GPIO_DRIVE_STRENGTH_2MA = 0,
+    GPIO_DRIVE_STRENGTH_4MA = 1,
+    GPIO_DRIVE_STRENGTH_8MA = 2,
+    GPIO_DRIVE_STRENGTH_12MA = 3
+};
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback);
+
+// Simula um aperto de botão: chama o callback registrado para o pino
+void sim_gpio_pressionar(uint gpio);
+
+// I2C
+typedef struct
+{
+    int indice;
+} i2c_inst_t;
+
+typedef struct
+{
+    volatile uint32_t enable;
+    volatile uint32_t tar;
+    volatile uint32_t data_cmd;
+    volatile uint32_t status;
+    volatile uint32_t raw_intr_stat;
+    volatile uint32_t clr_tx_abrt;
+} i2c_hw_t;
+
+#define I2C_IC_ENABLE_ENABLE_BITS 0x00000001u
+#define I2C_IC_ENABLE_ABORT_BITS 0x00000002u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_STATUS_ACTIVITY_BITS 0x00000001u
+#define I2C_IC_STATUS_TFE_BITS 0x00000004u
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+
+extern i2c_inst_t sim_i2c[2];
+#define i2c0 (&sim_i2c[0])
+#define i2c1 (&sim_i2c[1])
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c);
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx);
+
+// Clocks: o do sistema é informado como o padrão do RP2040 (125 MHz)
+enum clock_index
+{
+    clk_sys = 5
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+
+// ADC (joystick sempre centralizado)
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+uint16_t adc_read(void);
+
+// DMA e IRQ: nenhum canal disponível
+enum dma_channel_transfer_size
+{
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+typedef struct
+{
+    uint32_t ctrl;
+} dma_channel_config;
+
+typedef void (*irq_handler_t)(void);
+
+#define DMA_IRQ_0 11
+#define DMA_IRQ_1 12
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq1_status(uint channel);
+void dma_channel_acknowledge_irq1(uint channel);
+void dma_channel_abort(uint channel);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_set_enabled(uint num, bool enabled);
+
+// SPI: só os tipos usados por spi.h/hw_config.c (o cartão é um arquivo)
+typedef struct
+{
+    int indice;
+} spi_inst_t;
+
+extern spi_inst_t sim_spi[2];
+#define spi0 (&sim_spi[0])
+#define spi1 (&sim_spi[1])
+
+// Sincronização do pico-sdk (o driver simulado não precisa de trava própria)
+typedef struct
+{
+    int dono;
+} mutex_t;
+
+typedef struct
+{
+    int permissoes;
+} semaphore_t;
+
+#endif
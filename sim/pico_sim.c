@@ -0,0 +1,249 @@
+#include <errno.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "pico_sim.h"
+#include "sensor_sim.h"
+#include "my_debug.h"
+
+// Implementação no PC dos substitutos do pico-sdk (ver include/pico_sim.h)
+
+i2c_inst_t sim_i2c[2] = {{0}, {1}};
+spi_inst_t sim_spi[2] = {{0}, {1}};
+
+static gpio_irq_callback_t callback_gpio;
+static void (*callback_stdio)(void *);
+static void *param_stdio;
+static bool stdin_fechado;
+static bool nivel_gpio[32];
+static i2c_hw_t i2c_hw[2] = {{.status = I2C_IC_STATUS_TFE_BITS}, {.status = I2C_IC_STATUS_TFE_BITS}};
+
+static uint64_t agora_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Tempo contado a partir do início do processo, como o timer do RP2040 após o boot
+static uint64_t inicio_ns;
+
+__attribute__((constructor)) static void marcar_boot(void)
+{
+    inicio_ns = agora_ns();
+}
+
+uint64_t time_us_64(void)
+{
+    return (agora_ns() - inicio_ns) / 1000u;
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)time_us_64();
+}
+
+absolute_time_t get_absolute_time(void)
+{
+    return time_us_64();
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t)
+{
+    return (uint32_t)(t / 1000u);
+}
+
+// O sinal do tick do FreeRTOS interrompe o nanosleep: dorme o que faltar
+void sleep_us(uint64_t us)
+{
+    struct timespec ts = {.tv_sec = (time_t)(us / 1000000u), .tv_nsec = (long)(us % 1000000u) * 1000};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+        ;
+}
+
+void sleep_ms(uint32_t ms)
+{
+    sleep_us((uint64_t)ms * 1000u);
+}
+
+void busy_wait_us(uint64_t us)
+{
+    uint64_t fim = time_us_64() + us;
+    while (time_us_64() < fim)
+        ;
+}
+
+void stdio_init_all(void)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+// Console: lê o stdin do processo sem bloquear (ex.: echo tarefas | DataloggerSim)
+int getchar_timeout_us(uint32_t timeout_us)
+{
+    struct pollfd entrada = {.fd = STDIN_FILENO, .events = POLLIN};
+    unsigned char c;
+    if (poll(&entrada, 1, (int)(timeout_us / 1000)) <= 0 || !(entrada.revents & POLLIN))
+        return PICO_ERROR_TIMEOUT; // sem dado
+    if (read(STDIN_FILENO, &c, 1) != 1)
+    {
+        stdin_fechado = true; // fim do stdin: para de avisar o console
+        return PICO_ERROR_TIMEOUT;
+    }
+    return c;
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param)
+{
+    callback_stdio = fn;
+    param_stdio = param;
+}
+
+void sim_stdio_verificar(void)
+{
+    struct pollfd entrada = {.fd = STDIN_FILENO, .events = POLLIN};
+    if (callback_stdio && !stdin_fechado && poll(&entrada, 1, 0) > 0 && (entrada.revents & POLLIN))
+        callback_stdio(param_stdio);
+}
+
+void panic_unsupported(void)
+{
+    fprintf(stderr, "[SIM] panic_unsupported\n");
+    abort();
+}
+
+// O botão do joystick reinicia em modo BOOTSEL: no PC, encerra a simulação
+void reset_usb_boot(uint32_t gpio_mask, uint32_t disable_interface_mask)
+{
+    (void)gpio_mask;
+    (void)disable_interface_mask;
+    printf("[SIM] reset_usb_boot: encerrando\n");
+    exit(0);
+}
+
+void gpio_init(uint gpio) { (void)gpio; }
+void gpio_set_dir(uint gpio, bool out) { (void)gpio, (void)out; }
+void gpio_pull_up(uint gpio) { nivel_gpio[gpio & 31] = true; }
+void gpio_set_function(uint gpio, enum gpio_function fn) { (void)gpio, (void)fn; }
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive) { (void)gpio, (void)drive; }
+void gpio_put(uint gpio, bool value) { nivel_gpio[gpio & 31] = value; }
+bool gpio_get(uint gpio) { return nivel_gpio[gpio & 31]; }
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback)
+{
+    (void)gpio, (void)events, (void)enabled;
+    callback_gpio = callback; // o pico-sdk também guarda um único callback por núcleo
+}
+
+void sim_gpio_pressionar(uint gpio)
+{
+    if (callback_gpio)
+        callback_gpio(gpio, GPIO_IRQ_EDGE_FALL);
+}
+
+// Barramento I2C: os MPU6050 simulados respondem em 0x68/0x69 (os que não
+// estão ligados não reconhecem o endereço, como no hardware); o display (e
+// qualquer outro endereço) aceita as escritas e as descarta.
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    (void)i2c;
+    return baudrate;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+    (void)i2c;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)nostop;
+    if ((addr == 0x68 || addr == 0x69) && !sim_mpu6050_escrever(i2c->indice, addr, src, len))
+        return PICO_ERROR_GENERIC;
+    return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+    (void)nostop;
+    if (addr == 0x68 || addr == 0x69)
+    {
+        if (!sim_mpu6050_ler(i2c->indice, addr, dst, len))
+            return PICO_ERROR_GENERIC;
+    }
+    else
+    {
+        memset(dst, 0, len);
+    }
+    return (int)len;
+}
+
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c)
+{
+    return &i2c_hw[i2c->indice & 1];
+}
+
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx)
+{
+    return (uint)(i2c->indice * 2 + (is_tx ? 0 : 1));
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index)
+{
+    (void)clk_index;
+    return 125000000;
+}
+
+void adc_init(void) {}
+void adc_gpio_init(uint gpio) { (void)gpio; }
+void adc_select_input(uint input) { (void)input; }
+uint16_t adc_read(void) { return 2048; }
+
+int dma_claim_unused_channel(bool required)
+{
+    if (required)
+        panic_unsupported();
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    (void)channel;
+    return (dma_channel_config){0};
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { (void)c, (void)size; }
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) { (void)c, (void)incr; }
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) { (void)c, (void)incr; }
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) { (void)c, (void)dreq; }
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) { (void)channel, (void)enabled; }
+bool dma_channel_get_irq1_status(uint channel) { (void)channel; return false; }
+void dma_channel_acknowledge_irq1(uint channel) { (void)channel; }
+void dma_channel_abort(uint channel) { (void)channel; }
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) { (void)num, (void)handler, (void)order_priority; }
+void irq_set_enabled(uint num, bool enabled) { (void)num, (void)enabled; }
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    (void)channel, (void)config, (void)write_addr, (void)read_addr, (void)transfer_count, (void)trigger;
+}
+
+// my_debug.c usa instruções ARM no assert; aqui a versão para o PC
+void my_printf(const char *pcFormat, ...)
+{
+    va_list xArgs;
+    va_start(xArgs, pcFormat);
+    vprintf(pcFormat, xArgs);
+    va_end(xArgs);
+    fflush(stdout);
+}
+
+void my_assert_func(const char *file, int line, const char *func, const char *pred)
+{
+    fprintf(stderr, "assertion \"%s\" failed: file \"%s\", line %d, function: %s\n", pred, file, line, func);
+    abort();
+}
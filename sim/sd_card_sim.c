@@ -0,0 +1,153 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "ff.h"
+#include "diskio.h"
+#include "hw_config.h"
+#include "sd_card.h"
+#include "sd_spi.h"
+#include "trace.h"
+
+// Cartão SD simulado: substitui sd_card.c/sd_spi.c/spi.c no build do PC.
+// Os cartões de lib/hw_config.c continuam sendo usados; só as funções de
+// bloco passam a ler e escrever setores de 512 bytes em um arquivo de imagem
+// (SIM_IMAGEM, padrão sim_sd.img, criado com SIM_IMAGEM_MB megabytes).
+// Com SIM_MODELAR_SPI=1 cada transferência também espera o tempo que os
+// bytes levariam no barramento SPI no clock configurado (spi->baud_rate).
+// SIM_SD_GC_MS > 0 imita a coleta de lixo interna de cartões lentos: a cada
+// SIM_SD_GC_A_CADA escritas (padrão 32) uma delas demora esse tempo a mais.
+
+#define SETOR 512
+#define BYTES_POR_BLOCO (SETOR + 10) // token, CRC, resposta e bytes de preenchimento
+
+static int fd_imagem = -1;
+static bool modelar_spi;
+static uint32_t gc_ms, gc_a_cada, escritas;
+
+static void esperar_barramento(sd_card_t *pSD, uint32_t blocos)
+{
+    if (modelar_spi && pSD->spi->baud_rate)
+    {
+        TRACE_INICIO(TRACE_SPI_DMA, blocos * SETOR);
+        busy_wait_us((uint64_t)blocos * BYTES_POR_BLOCO * 8 * 1000000u / pSD->spi->baud_rate);
+        TRACE_FIM(TRACE_SPI_DMA, 1);
+    }
+}
+
+static int sim_sd_init(sd_card_t *pSD)
+{
+    if (fd_imagem < 0)
+    {
+        const char *caminho = getenv("SIM_IMAGEM");
+        const char *mb = getenv("SIM_IMAGEM_MB");
+        const char *modelo = getenv("SIM_MODELAR_SPI");
+        const char *gc = getenv("SIM_SD_GC_MS");
+        const char *gc_intervalo = getenv("SIM_SD_GC_A_CADA");
+        modelar_spi = modelo && *modelo == '1';
+        gc_ms = gc ? (uint32_t)atoi(gc) : 0;
+        gc_a_cada = gc_intervalo && atoi(gc_intervalo) > 0 ? (uint32_t)atoi(gc_intervalo) : 32;
+        if (!caminho || !*caminho)
+            caminho = "sim_sd.img";
+
+        fd_imagem = open(caminho, O_RDWR | O_CREAT, 0644);
+        if (fd_imagem < 0)
+        {
+            printf("[SIM] Não foi possível abrir a imagem %s\n", caminho);
+            pSD->m_Status |= STA_NOINIT;
+            return pSD->m_Status;
+        }
+
+        off_t tamanho = lseek(fd_imagem, 0, SEEK_END);
+        if (tamanho < SETOR)
+        {
+            tamanho = (off_t)(mb ? atoi(mb) : 64) * 1024 * 1024;
+            if (ftruncate(fd_imagem, tamanho) != 0)
+            {
+                pSD->m_Status |= STA_NOINIT;
+                return pSD->m_Status;
+            }
+            printf("[SIM] Imagem %s criada (%ld MB)\n", caminho, (long)(tamanho >> 20));
+        }
+        pSD->sectors = (uint64_t)tamanho / SETOR;
+    }
+    pSD->m_Status &= ~STA_NOINIT;
+    return pSD->m_Status;
+}
+
+static int sim_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer, uint64_t ulSectorNumber, uint32_t blockCnt)
+{
+    if (pSD->m_Status & STA_NOINIT)
+        return SD_BLOCK_DEVICE_ERROR_NO_INIT;
+    if (ulSectorNumber + blockCnt > pSD->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    size_t n = (size_t)blockCnt * SETOR;
+    TRACE_INICIO(TRACE_SD_BLOCO, blockCnt);
+    if (pwrite(fd_imagem, buffer, n, (off_t)(ulSectorNumber * SETOR)) != (ssize_t)n)
+    {
+        TRACE_FIM(TRACE_SD_BLOCO, 0);
+        return SD_BLOCK_DEVICE_ERROR_WRITE;
+    }
+    esperar_barramento(pSD, blockCnt);
+    if (gc_ms && ++escritas % gc_a_cada == 0)
+        busy_wait_us((uint64_t)gc_ms * 1000);
+    TRACE_FIM(TRACE_SD_BLOCO, blockCnt);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static int sim_sd_read_blocks(sd_card_t *pSD, uint8_t *buffer, uint64_t ulSectorNumber, uint32_t ulSectorCount)
+{
+    if (pSD->m_Status & STA_NOINIT)
+        return SD_BLOCK_DEVICE_ERROR_NO_INIT;
+    if (ulSectorNumber + ulSectorCount > pSD->sectors)
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    size_t n = (size_t)ulSectorCount * SETOR;
+    if (pread(fd_imagem, buffer, n, (off_t)(ulSectorNumber * SETOR)) != (ssize_t)n)
+        return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
+    esperar_barramento(pSD, ulSectorCount);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+bool sd_init_driver()
+{
+    static bool initialized;
+    if (!initialized)
+    {
+        for (size_t i = 0; i < sd_get_num(); ++i)
+        {
+            sd_card_t *pSD = sd_get_by_num(i);
+            pSD->m_Status = STA_NOINIT;
+            pSD->init = sim_sd_init;
+            pSD->write_blocks = sim_sd_write_blocks;
+            pSD->read_blocks = sim_sd_read_blocks;
+        }
+        initialized = true;
+    }
+    return true;
+}
+
+bool sd_card_detect(sd_card_t *pSD)
+{
+    pSD->m_Status &= ~STA_NODISK; // a imagem está sempre "inserida"
+    return true;
+}
+
+// Troca de clock pelo benchmark: o novo spi->baud_rate só muda o modelo do barramento
+void sd_spi_go_high_frequency(sd_card_t *pSD)
+{
+    (void)pSD;
+}
+
+uint64_t sd_sectors(sd_card_t *pSD)
+{
+    return pSD->sectors;
+}
+
+// Data dos arquivos: relógio do PC (no RP2040 vem de rtc.c)
+DWORD get_fattime(void)
+{
+    time_t agora = time(NULL);
+    struct tm *t = localtime(&agora);
+    return ((DWORD)(t->tm_year - 80) << 25) | ((DWORD)(t->tm_mon + 1) << 21) | ((DWORD)t->tm_mday << 16) |
+           ((DWORD)t->tm_hour << 11) | ((DWORD)t->tm_min << 5) | ((DWORD)t->tm_sec >> 1);
+}
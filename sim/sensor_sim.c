@@ -0,0 +1,229 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico_sim.h"
+#include "sensor_sim.h"
+
+#define REG_ACCEL_CONFIG 0x1C
+#define REG_MOT_THR 0x1F
+#define REG_INT_ENABLE 0x38
+#define REG_INT_STATUS 0x3A
+#define REG_ACCEL_XOUT_H 0x3B
+#define REG_TEMP_OUT_H 0x41
+#define REG_GYRO_XOUT_H 0x43
+#define REG_PWR_MGMT_1 0x6B
+#define REG_WHO_AM_I 0x75
+
+#define INT_MOT (1 << 6)
+
+#define PI_F 3.14159265f
+#define SENSORES_SIM 4
+
+typedef struct
+{
+    uint8_t regs[128];
+    uint8_t ponteiro;
+    int16_t acel_ant[3]; // amostra anterior, para a detecção de movimento
+} mpu_sim_t;
+
+static mpu_sim_t mpus[SENSORES_SIM];
+static int ligados = -1; // SIM_SENSORES, lido no primeiro acesso
+static FILE *replay;
+static bool replay_aberto;
+
+// Sensor ligado no barramento/endereço, ou NULL se ninguém responde
+static mpu_sim_t *sensor_em(int barramento, uint8_t endereco)
+{
+    if (ligados < 0)
+    {
+        const char *n = getenv("SIM_SENSORES");
+        ligados = (n && *n) ? atoi(n) : 1;
+        if (ligados < 1)
+            ligados = 1;
+        if (ligados > SENSORES_SIM)
+            ligados = SENSORES_SIM;
+    }
+    if (endereco != 0x68 && endereco != 0x69)
+        return NULL;
+    int id = (barramento & 1) * 2 + (endereco - 0x68);
+    return id < ligados ? &mpus[id] : NULL;
+}
+
+static float escala_acel(const mpu_sim_t *m)
+{
+    return 16384.0f / (1 << ((m->regs[REG_ACCEL_CONFIG] >> 3) & 3));
+}
+
+static float escala_giro(const mpu_sim_t *m)
+{
+    static const float escala[] = {131.0f, 65.5f, 32.8f, 16.4f};
+    return escala[(m->regs[0x1B] >> 3) & 3];
+}
+
+static int16_t saturar(float v)
+{
+    if (v > 32767.0f)
+        return 32767;
+    if (v < -32768.0f)
+        return -32768;
+    return (int16_t)lrintf(v);
+}
+
+static void escrever_par(mpu_sim_t *m, uint8_t reg, int16_t v)
+{
+    m->regs[reg] = (uint8_t)((uint16_t)v >> 8);
+    m->regs[reg + 1] = (uint8_t)v;
+}
+
+// Amostra sintética: gravidade em Z e senoides de frequências distintas,
+// adiantadas 250 ms a cada sensor
+static void gerar_sintetica(const mpu_sim_t *m, int16_t acel[3], int16_t giro[3])
+{
+    float t = time_us_64() / 1e6f + 0.25f * (float)(m - mpus);
+    float a[3] = {0.5f * sinf(2 * PI_F * 1.0f * t), 0.25f * sinf(2 * PI_F * 0.3f * t), 1.0f + 0.1f * sinf(2 * PI_F * 2.0f * t)};
+    float g[3] = {45.0f * sinf(2 * PI_F * 0.5f * t), 20.0f * cosf(2 * PI_F * 0.2f * t), 90.0f * sinf(2 * PI_F * 0.1f * t)};
+    for (int i = 0; i < 3; i++)
+    {
+        acel[i] = saturar(a[i] * escala_acel(m));
+        giro[i] = saturar(g[i] * escala_giro(m));
+    }
+}
+
+bool sim_replay_eixos(const char *linha, float valores[6], bool fisico[6])
+{
+    const char *campos[32];
+    int n = 0;
+    const char *p = linha;
+    campos[n++] = p;
+    for (; *p && n < 32; p++)
+        if (*p == ';' || *p == ',')
+            campos[n++] = p + 1;
+    if (n < 6)
+        return false;
+    int primeiro = n == 6 ? 0 : n == 7 ? 1 : 2;
+
+    for (int i = 0; i < 6; i++)
+    {
+        const char *c = campos[primeiro + i];
+        char *fim;
+        valores[i] = strtof(c, &fim);
+        if (fim == c)
+            return false;
+        fisico[i] = memchr(c, '.', (size_t)(fim - c)) != NULL;
+    }
+    return true;
+}
+
+// Eixos de uma linha do replay em contagens do fundo de escala configurado
+static bool ler_linha_replay(const mpu_sim_t *m, const char *linha, int16_t acel[3], int16_t giro[3])
+{
+    float v[6];
+    bool fisico[6];
+    if (!sim_replay_eixos(linha, v, fisico))
+        return false;
+    for (int i = 0; i < 3; i++)
+    {
+        acel[i] = saturar(fisico[i] ? v[i] * escala_acel(m) : v[i]);
+        giro[i] = saturar(fisico[i + 3] ? v[i + 3] * escala_giro(m) : v[i + 3]);
+    }
+    return true;
+}
+
+static bool gerar_replay(const mpu_sim_t *m, int16_t acel[3], int16_t giro[3])
+{
+    char linha[256];
+    for (int voltas = 0; voltas < 2;)
+    {
+        if (!fgets(linha, sizeof(linha), replay))
+        {
+            rewind(replay);
+            voltas++;
+            continue;
+        }
+        if (ler_linha_replay(m, linha, acel, giro))
+            return true;
+    }
+    return false; // arquivo sem nenhuma linha válida
+}
+
+static void gerar_amostra(mpu_sim_t *m)
+{
+    if (!replay_aberto)
+    {
+        replay_aberto = true;
+        const char *caminho = getenv("SIM_SENSOR");
+        if (caminho && *caminho)
+        {
+            replay = fopen(caminho, "r");
+            if (replay)
+                printf("[SIM] Sensor: replay de %s\n", caminho);
+            else
+                printf("[SIM] Não foi possível abrir %s: usando sensor sintético\n", caminho);
+        }
+    }
+
+    int16_t acel[3], giro[3];
+    if (!replay || !gerar_replay(m, acel, giro))
+        gerar_sintetica(m, acel, giro);
+
+    // Detecção de movimento: a variação entre duas amostras faz o papel do
+    // passa-altas do sensor; MOT_THR vale 2 mg/LSB
+    if (m->regs[REG_INT_ENABLE] & INT_MOT)
+    {
+        float limiar = m->regs[REG_MOT_THR] * 0.002f * escala_acel(m);
+        for (int i = 0; i < 3; i++)
+            if (fabsf((float)acel[i] - m->acel_ant[i]) > limiar)
+                m->regs[REG_INT_STATUS] |= INT_MOT;
+    }
+    memcpy(m->acel_ant, acel, sizeof(m->acel_ant));
+
+    for (int i = 0; i < 3; i++)
+    {
+        escrever_par(m, REG_ACCEL_XOUT_H + 2 * i, acel[i]);
+        escrever_par(m, REG_GYRO_XOUT_H + 2 * i, giro[i]);
+    }
+    escrever_par(m, REG_TEMP_OUT_H, (int16_t)((25.0f - 36.53f) * 340.0f)); // 25 °C
+}
+
+bool sim_mpu6050_escrever(int barramento, uint8_t endereco, const uint8_t *src, size_t len)
+{
+    mpu_sim_t *m = sensor_em(barramento, endereco);
+    if (m == NULL)
+        return false;
+    if (len == 0)
+        return true;
+    m->ponteiro = src[0] & 0x7F;
+    for (size_t i = 1; i < len; i++)
+    {
+        uint8_t reg = m->ponteiro;
+        m->ponteiro = (m->ponteiro + 1) & 0x7F;
+        if (reg == REG_PWR_MGMT_1 && (src[i] & 0x80))
+        {
+            memset(m->regs, 0, sizeof(m->regs)); // DEVICE_RESET
+            m->regs[REG_PWR_MGMT_1] = 0x40;
+            continue;
+        }
+        if (reg != REG_WHO_AM_I)
+            m->regs[reg] = src[i];
+    }
+    return true;
+}
+
+bool sim_mpu6050_ler(int barramento, uint8_t endereco, uint8_t *dst, size_t len)
+{
+    mpu_sim_t *m = sensor_em(barramento, endereco);
+    if (m == NULL)
+        return false;
+    m->regs[REG_WHO_AM_I] = 0x68;
+    if (m->ponteiro == REG_ACCEL_XOUT_H || m->ponteiro == REG_INT_STATUS)
+        gerar_amostra(m);
+    for (size_t i = 0; i < len; i++)
+    {
+        dst[i] = m->regs[m->ponteiro];
+        if (m->ponteiro == REG_INT_STATUS)
+            m->regs[REG_INT_STATUS] = 0; // zerado na leitura
+        m->ponteiro = (m->ponteiro + 1) & 0x7F;
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef SENSOR_SIM_H
+#define SENSOR_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// MPU6050 simulado no nível de registradores, atrás do I2C falso de
+// pico_sim.c, para que lib/mpu6050.c rode sem alterações no PC.
+//
+// SIM_SENSORES=N (1 a 4, padrão 1) liga os N primeiros sensores na ordem dos
+// identificadores de lib/sensores.h (i2c0/0x68, i2c0/0x69, i2c1/0x68,
+// i2c1/0x69); os demais endereços não respondem. Cada sensor tem seus
+// registradores e, no modo sintético, as senoides defasadas.
+//
+// A cada leitura a partir de ACCEL_XOUT_H (0x3B) ou INT_STATUS (0x3A) uma
+// nova amostra é gerada:
+//  - sintética (padrão): 1 g em Z mais senoides em todos os eixos;
+//  - replay: com SIM_SENSOR=<arquivo>, repete as linhas de um CSV gravado
+//    pelo datalogger (os 6 eixos, depois de numero_amostra e sensor; as
+//    colunas de orientação são ignoradas; valores com ponto decimal são lidos
+//    em g e graus/s e convertidos pelo fundo de escala configurado, inteiros
+//    são contagens brutas). O arquivo recomeça ao chegar ao fim. Com vários
+//    sensores as linhas são consumidas em sequência por todos, como a
+//    rajada intercalada do log gravado.
+// Com MOT_EN no INT_ENABLE, MOT_INT sobe no INT_STATUS quando algum eixo do
+// acelerômetro varia mais que MOT_THR (2 mg/LSB) de uma amostra para a outra.
+
+// Transação de escrita: primeiro byte é o registrador, os demais são dados.
+// Retorna false se não há sensor ligado no barramento e endereço.
+bool sim_mpu6050_escrever(int barramento, uint8_t endereco, const uint8_t *src, size_t len);
+
+// Transação de leitura a partir do último registrador endereçado
+bool sim_mpu6050_ler(int barramento, uint8_t endereco, uint8_t *dst, size_t len);
+
+// Lê os 6 eixos de uma linha do replay (';' ou ','), depois do número da
+// amostra e do sensor quando presentes: 6 colunas são só os eixos, 7 são o
+// formato antigo (numero_amostra e eixos) e 8 ou mais o atual, em que as
+// colunas depois dos eixos (roll, pitch e yaw) são ignoradas. 'fisico' diz
+// se o valor tem ponto decimal (g ou graus/s) ou é uma contagem bruta.
+// Retorna false em linhas sem 6 valores numéricos, como o cabeçalho.
+bool sim_replay_eixos(const char *linha, float valores[6], bool fisico[6]);
+
+#endif
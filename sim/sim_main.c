@@ -0,0 +1,372 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "ff.h"
+#include "hw_config.h"
+#include "sd_card.h"
+#include "lzblock.h"
+#include "bench_sd.h"
+#include "sensores.h"
+#include "diagnostico.h"
+#include "pico_sim.h"
+#include "sensor_sim.h"
+
+// Roteiro da simulação: faz no lugar do usuário o que os botões fariam
+// (monta o cartão, captura por SIM_SEGUNDOS, para e desmonta) e no fim
+// confere o arquivo gravado na imagem contra os contadores da captura: cada
+// leitura que entrou na fila (diag.amostras_lidas - diag.amostras_perdidas)
+// deve estar no arquivo, e nenhuma pode ter sido descartada. No replay os
+// valores gravados também são comparados com os do CSV de entrada.
+//
+// Variáveis de ambiente:
+//   SIM_IMAGEM, SIM_IMAGEM_MB  imagem do cartão (ver sd_card_sim.c)
+//   SIM_SENSOR                 CSV para replay (ver sensor_sim.h)
+//   SIM_SENSORES               quantidade de MPU6050 ligados, 1 a 4 (idem)
+//   SIM_CONFIG                 arquivo copiado para config.ini antes de montar
+//   SIM_SEGUNDOS               duração da captura (padrão 5)
+//   SIM_BENCH=1                roda o benchmark do cartão no lugar da captura
+//                              (com SIM_MODELAR_SPI=1 o clock do SPI conta)
+//   SIM_ESTRESSE=1|sint        monta o cartão e roda o benchmark de estresse
+//                              com o sensor simulado (1) ou a fonte sintética
+//   SIM_JITTER=1               monta o cartão e roda o benchmark de jitter
+//   SIM_CALIBRAR=<args>        roda "calibrar <args>" antes da captura, que
+//                              já sai corrigida (ex.: SIM_CALIBRAR=giro)
+
+#define SIM_BOTAO_A 5 // mesmos pinos de Datalogger.c
+#define SIM_BOTAO_B 6
+#define SIM_LED_VERDE 11
+#define SIM_LED_VERMELHO 13
+
+extern volatile int numero_amostra;
+extern volatile uint32_t registros_omitidos; // fora dos eventos do gatilho
+void estresse_executar(bool sintetica); // Datalogger.c
+void jitter_executar(void);
+void calibrar_executar(const char *args);
+
+// Espera o LED ficar só verde (cartão montado, sem captura), como o usuário
+// faria antes de apertar A: a montagem inclui o aquecimento do cartão
+static bool esperar_pronto(void)
+{
+    vTaskDelay(pdMS_TO_TICKS(500)); // LED amarelo da montagem e debounce (200 ms) dos botões
+    for (int i = 0; i < 600; i++)
+    {
+        if (gpio_get(SIM_LED_VERDE) && !gpio_get(SIM_LED_VERMELHO))
+            return true;
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    printf("[SIM] O cartão não ficou pronto\n");
+    return false;
+}
+
+static uint32_t ler_env(const char *nome, uint32_t padrao)
+{
+    const char *v = getenv(nome);
+    return (v && *v) ? (uint32_t)strtoul(v, NULL, 10) : padrao;
+}
+
+// Formata a imagem se preciso, instala o config.ini pedido e apaga os dados
+// de execuções anteriores, para que a contagem final seja exata
+static bool preparar_cartao(sd_card_t *sd)
+{
+    static BYTE trabalho[FF_MAX_SS * 8];
+    FRESULT fr = f_mount(&sd->fatfs, sd->pcName, 1);
+    if (fr == FR_NO_FILESYSTEM)
+    {
+        MKFS_PARM opt = {FM_ANY, 0, 0, 0, 0};
+        printf("[SIM] Formatando a imagem...\n");
+        fr = f_mkfs(sd->pcName, &opt, trabalho, sizeof(trabalho));
+        if (fr == FR_OK)
+            fr = f_mount(&sd->fatfs, sd->pcName, 1);
+    }
+    if (fr != FR_OK)
+    {
+        printf("[SIM] Falha ao preparar a imagem: %d\n", fr);
+        return false;
+    }
+
+    const char *config = getenv("SIM_CONFIG");
+    if (config && *config)
+    {
+        FILE *origem = fopen(config, "rb");
+        FIL destino;
+        if (origem && f_open(&destino, "config.ini", FA_WRITE | FA_CREATE_ALWAYS) == FR_OK)
+        {
+            UINT bw;
+            size_t n;
+            while ((n = fread(trabalho, 1, sizeof(trabalho), origem)) > 0)
+                f_write(&destino, trabalho, (UINT)n, &bw);
+            f_close(&destino);
+            printf("[SIM] config.ini copiado de %s\n", config);
+        }
+        if (origem)
+            fclose(origem);
+    }
+
+    f_unlink("dados.csv");
+    f_unlink("dados.lzb");
+    f_unlink("calib.ini"); // a calibração mudaria os valores do replay
+    f_unmount(sd->pcName);
+    return true;
+}
+
+// Passa o texto do arquivo de dados (CSV direto ou blocos LZB
+// descomprimidos), em trechos, para 'trecho'. Retorna false se o arquivo não
+// existir ou estiver corrompido.
+static bool percorrer_dados(sd_card_t *sd, void (*trecho)(const uint8_t *p, size_t n, void *ctx), void *ctx)
+{
+    static uint8_t entrada[LZB_BOUND(0xFFFF)];
+    static uint8_t saida[0xFFFF];
+    FIL file;
+    UINT br;
+    bool ok = false;
+
+    if (f_mount(&sd->fatfs, sd->pcName, 1) != FR_OK)
+        return false;
+
+    if (f_open(&file, "dados.csv", FA_READ) == FR_OK)
+    {
+        ok = true;
+        while (f_read(&file, entrada, sizeof(entrada), &br) == FR_OK && br > 0)
+            trecho(entrada, br, ctx);
+        f_close(&file);
+    }
+    else if (f_open(&file, "dados.lzb", FA_READ) == FR_OK)
+    {
+        uint16_t raw_len, payload_len, crc;
+        uint8_t flags;
+        ok = true;
+        while (f_read(&file, entrada, LZB_HEADER_SIZE, &br) == FR_OK && br == LZB_HEADER_SIZE)
+        {
+            if (!lzb_parse_header(entrada, &raw_len, &payload_len, &crc, &flags) ||
+                f_read(&file, entrada + LZB_HEADER_SIZE, payload_len, &br) != FR_OK || br != payload_len)
+            {
+                ok = false;
+                break;
+            }
+            int n = lzb_decode_block(entrada, LZB_HEADER_SIZE + payload_len, saida, sizeof(saida));
+            if (n < 0)
+            {
+                ok = false;
+                break;
+            }
+            trecho(saida, (size_t)n, ctx);
+        }
+        f_close(&file);
+    }
+
+    f_unmount(sd->pcName);
+    return ok;
+}
+
+static void contar_linhas(const uint8_t *p, size_t n, void *ctx)
+{
+    int32_t *linhas = ctx;
+    for (size_t i = 0; i < n; i++)
+        *linhas += (p[i] == '\n');
+}
+
+// Conta as linhas do arquivo de dados. Retorna -1 se o arquivo não existir
+// ou estiver corrompido.
+static int32_t linhas_gravadas(sd_card_t *sd)
+{
+    int32_t linhas = 0;
+    return percorrer_dados(sd, contar_linhas, &linhas) ? linhas : -1;
+}
+
+// Conferência do replay: o k-ésimo registro do log traz os eixos da k-ésima
+// linha válida do CSV de entrada (a leitura k consumiu essa linha; o
+// arquivo recomeça no fim). A comparação é em contagens do fundo de escala
+// do sensor; valores gravados com 2 casas têm a tolerância do arredondamento.
+typedef struct
+{
+    FILE *entrada;
+    char linha[256];
+    size_t len;
+    uint32_t registros;
+    uint32_t divergentes;
+} replay_t;
+
+static bool proxima_entrada(replay_t *r, float v[6], bool fisico[6])
+{
+    char linha[256];
+    for (int voltas = 0; voltas < 2;)
+    {
+        if (!fgets(linha, sizeof(linha), r->entrada))
+        {
+            rewind(r->entrada);
+            voltas++;
+            continue;
+        }
+        if (sim_replay_eixos(linha, v, fisico))
+            return true;
+    }
+    return false;
+}
+
+static void conferir_registro(replay_t *r, const char *linha)
+{
+    float gravado[6], esperado[6];
+    bool fisico_gravado[6], fisico_esperado[6];
+    if (!sim_replay_eixos(linha, gravado, fisico_gravado))
+        return; // cabeçalho
+    r->registros++;
+    if (!proxima_entrada(r, esperado, fisico_esperado))
+    {
+        r->divergentes++;
+        return;
+    }
+
+    float escala_acel, escala_giro;
+    sensores_escalas((uint8_t)strtoul(strchr(linha, ';') + 1, NULL, 10), &escala_acel, &escala_giro);
+    for (int i = 0; i < 6; i++)
+    {
+        float escala = i < 3 ? escala_acel : escala_giro;
+        float g = fisico_gravado[i] ? gravado[i] * escala : gravado[i];
+        float e = fisico_esperado[i] ? lrintf(esperado[i] * escala) : esperado[i];
+        e = e > 32767.0f ? 32767.0f : e < -32768.0f ? -32768.0f : e; // o sensor satura
+        float tolerancia = fisico_gravado[i] ? 0.005f * escala + 0.5f : 0.0f;
+        if (fabsf(g - e) > tolerancia)
+        {
+            if (r->divergentes++ == 0)
+                printf("[SIM] Replay: registro %lu diverge no eixo %d (%.1f gravado, %.1f esperado): %s",
+                       (unsigned long)r->registros, i, g, e, linha);
+            return;
+        }
+    }
+}
+
+static void conferir_trecho(const uint8_t *p, size_t n, void *ctx)
+{
+    replay_t *r = ctx;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (r->len < sizeof(r->linha) - 1)
+            r->linha[r->len++] = (char)p[i];
+        if (p[i] != '\n')
+            continue;
+        r->linha[r->len] = '\0';
+        conferir_registro(r, r->linha);
+        r->len = 0;
+    }
+}
+
+// Retorna false se algum registro divergir da entrada
+static bool conferir_replay(sd_card_t *sd, const char *caminho)
+{
+    replay_t r = {0};
+    r.entrada = fopen(caminho, "r");
+    if (r.entrada == NULL)
+        return false;
+    bool ok = percorrer_dados(sd, conferir_trecho, &r);
+    fclose(r.entrada);
+    printf("[SIM] Replay: %lu registros conferidos com %s, %lu divergentes\n", (unsigned long)r.registros, caminho,
+           (unsigned long)r.divergentes);
+    return ok && r.registros > 0 && r.divergentes == 0;
+}
+
+static void vRoteiroTask(void *params)
+{
+    sd_card_t *sd = sd_get_by_num(0);
+    uint32_t segundos = ler_env("SIM_SEGUNDOS", 5);
+
+    // Espera o sensor inicializar e passar o debounce de 200 ms dos botões
+    vTaskDelay(pdMS_TO_TICKS(500));
+    if (!preparar_cartao(sd))
+        exit(2);
+
+    if (ler_env("SIM_BENCH", 0))
+    {
+        // Sem passar pela máquina de estados: as tarefas ficam em ESTADO_SEM_SD
+        if (f_mount(&sd->fatfs, sd->pcName, 1) != FR_OK)
+            exit(2);
+        bench_sd_executar(sd);
+        f_unmount(sd->pcName);
+        fflush(stdout);
+        exit(0);
+    }
+
+    printf("[SIM] Montando o cartão\n");
+    sim_gpio_pressionar(SIM_BOTAO_B);
+    if (!esperar_pronto())
+        exit(2);
+    int inicio = numero_amostra;
+
+    const char *estresse = getenv("SIM_ESTRESSE");
+    bool jitter = ler_env("SIM_JITTER", 0);
+    if ((estresse && *estresse) || jitter)
+    {
+        if (jitter)
+            jitter_executar();
+        else
+            estresse_executar(strcmp(estresse, "sint") == 0);
+        sim_gpio_pressionar(SIM_BOTAO_B);
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        fflush(stdout);
+        exit(0);
+    }
+
+    const char *calibrar = getenv("SIM_CALIBRAR");
+    if (calibrar && *calibrar)
+        calibrar_executar(calibrar);
+    diagnostico_t antes = diag;
+    uint32_t omitidos_antes = registros_omitidos;
+
+    printf("[SIM] Capturando por %u s\n", (unsigned)segundos);
+    uint32_t t0 = time_us_32();
+    sim_gpio_pressionar(SIM_BOTAO_A);
+    vTaskDelay(pdMS_TO_TICKS(segundos * 1000));
+    sim_gpio_pressionar(SIM_BOTAO_A);
+    uint32_t duracao_us = time_us_32() - t0;
+
+    vTaskDelay(pdMS_TO_TICKS(500));
+    printf("[SIM] Desmontando o cartão\n");
+    sim_gpio_pressionar(SIM_BOTAO_B);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+
+    // Dados = todas as linhas menos o cabeçalho: cada leitura que entrou na
+    // fila, menos as que o gatilho deixou fora dos eventos
+    uint32_t lidas = diag.amostras_lidas - antes.amostras_lidas;
+    uint32_t perdidas = diag.amostras_perdidas - antes.amostras_perdidas;
+    uint32_t omitidos = registros_omitidos - omitidos_antes;
+    int32_t esperadas = (int32_t)(lidas - perdidas - omitidos);
+    int32_t linhas = linhas_gravadas(sd);
+    int32_t gravadas = linhas > 0 ? linhas - 1 : linhas;
+    printf("[SIM] Registros: %lu lidos, %lu perdidos, %lu fora dos eventos, %ld no arquivo (%.1f amostras/s de %u "
+           "sensor(es))\n",
+           (unsigned long)lidas, (unsigned long)perdidas, (unsigned long)omitidos, (long)gravadas,
+           (numero_amostra - inicio) * 1e6 / duracao_us, sensores_qtd());
+
+    bool ok = esperadas > 0 && gravadas == esperadas && perdidas == 0;
+
+    // Replay: com o gatilho ou a calibração os registros não seguem a entrada
+    const char *replay = getenv("SIM_SENSOR");
+    if (ok && replay && *replay)
+    {
+        if (omitidos || (calibrar && *calibrar))
+            printf("[SIM] Replay: valores não conferidos (gatilho ou calibração)\n");
+        else
+            ok = conferir_replay(sd, replay);
+    }
+    printf("[SIM] %s\n", ok ? "OK" : "FALHA");
+    fflush(stdout);
+    exit(ok ? 0 : 1);
+}
+
+// Faz a vez da IRQ do USB: avisa o console quando há dado no stdin
+static void vStdinTask(void *params)
+{
+    while (true)
+    {
+        sim_stdio_verificar();
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
+
+// Chamado pelo FreeRTOS quando o agendador já está rodando
+void vApplicationDaemonTaskStartupHook(void)
+{
+    xTaskCreate(vRoteiroTask, "Roteiro", configMINIMAL_STACK_SIZE * 4, NULL, 1, NULL);
+    xTaskCreate(vStdinTask, "Stdin", configMINIMAL_STACK_SIZE, NULL, 1, NULL);
+}